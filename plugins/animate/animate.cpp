@@ -19,6 +19,20 @@ bool animation_base::step()
     return false;
 }
 
+wf::region_t animation_base::get_step_damage(wf::geometry_t before,
+    wf::geometry_t after)
+{
+    wf::region_t damage{before};
+    damage |= after;
+
+    return damage;
+}
+
+wf::animation::duration_t*animation_base::get_duration()
+{
+    return nullptr;
+}
+
 animation_base::~animation_base()
 {}
 
@@ -46,13 +60,36 @@ struct animation_hook : public animation_hook_base
     /* Update animation right before each frame */
     wf::effect_hook_t update_animation_hook = [=] ()
     {
-        view->damage();
+        /* Sticky views are visible on all workspaces, let the view figure out
+         * where to damage them. */
+        if (view->sticky)
+        {
+            view->damage();
+            bool result = animation->step();
+            view->damage();
+            if (!result)
+            {
+                stop_hook(false);
+            }
+
+            return;
+        }
+
+        /* Damage directly on the output instead of view->damage(), because the
+         * view contents did not change, just the way they are displayed. This
+         * way, any snapshot of the view remains valid. */
+        auto before = view->get_bounding_box();
         bool result = animation->step();
-        view->damage();
+        auto after  = view->get_bounding_box();
 
         if (!result)
         {
+            current_output->render->damage(wf::region_t{before} | after);
             stop_hook(false);
+        } else
+        {
+            current_output->render->damage(
+                animation->get_step_damage(before, after));
         }
     };
 
@@ -62,15 +99,24 @@ struct animation_hook : public animation_hook_base
      */
     void set_output(wf::output_t *new_output)
     {
+        auto duration = animation ? animation->get_duration() : nullptr;
         if (current_output)
         {
             current_output->render->rem_effect(&update_animation_hook);
+            if (duration)
+            {
+                current_output->render->rem_animation(duration);
+            }
         }
 
         if (new_output)
         {
             new_output->render->add_effect(&update_animation_hook,
                 wf::OUTPUT_EFFECT_PRE);
+            if (duration)
+            {
+                new_output->render->add_animation(duration, view);
+            }
         }
 
         current_output = new_output;
@@ -2,6 +2,7 @@
 #define ANIMATE_H_
 
 #include <wayfire/view.hpp>
+#include <wayfire/util.hpp>
 #include <wayfire/util/duration.hpp>
 #include <wayfire/option-wrapper.hpp>
 
@@ -23,6 +24,25 @@ class animation_base
   public:
     virtual void init(wayfire_view view, int duration, wf_animation_type type);
     virtual bool step(); /* return true if continue, false otherwise */
+
+    /**
+     * Get the region which needs to be repainted after the last step(), in
+     * output-local coordinates. By default, this is the union of the bounding
+     * boxes of the view before and after the step.
+     *
+     * @param before The bounding box of the view before the step.
+     * @param after The bounding box of the view after the step.
+     */
+    virtual wf::region_t get_step_damage(wf::geometry_t before,
+        wf::geometry_t after);
+
+    /**
+     * Get the duration which drives the animation, if any. It is registered
+     * with the frame clock of the output the view is on, which then repaints
+     * until it has finished.
+     */
+    virtual wf::animation::duration_t *get_duration();
+
     virtual ~animation_base();
 };
 
@@ -41,6 +41,11 @@ class fade_animation : public animation_base
         return progression.running();
     }
 
+    wf::animation::duration_t *get_duration() override
+    {
+        return &progression;
+    }
+
     ~fade_animation()
     {
         view->pop_transformer(name);
@@ -66,6 +71,10 @@ class zoom_animation : public animation_base
     zoom_animation_t progression;
     std::string name;
 
+    /* The resolution of the snapshot of an unmapped view, relative to its
+     * original size. */
+    float snapshot_scale = 1.0;
+
   public:
 
     void init(wayfire_view view, int dur, wf_animation_type type) override
@@ -130,9 +139,23 @@ class zoom_animation : public animation_base
         our_transform->translation_x = this->progression.offset_x;
         our_transform->translation_y = this->progression.offset_y;
 
+        /* A view being unmapped is displayed from its snapshot. Once it has
+         * shrunk enough, halve the snapshot so we don't keep sampling it at
+         * full size. */
+        if (!view->is_mapped() && (c < snapshot_scale / 2))
+        {
+            snapshot_scale /= 2;
+            view->downscale_snapshot(0.5);
+        }
+
         return this->progression.running();
     }
 
+    wf::animation::duration_t *get_duration() override
+    {
+        return &progression;
+    }
+
     ~zoom_animation()
     {
         view->pop_transformer(name);
@@ -77,7 +77,13 @@ class FireTransformer : public wf::view_transformer_t
         return view;
     }
 
-    float progress_line;
+    /* The geometry of the view, before this transformer was applied */
+    wf::geometry_t get_view_box() const
+    {
+        return last_boundingbox;
+    }
+
+    float progress_line = 0;
     void set_progress_line(float line)
     {
         progress_line = line;
@@ -152,12 +158,17 @@ void FireAnimation::init(wayfire_view view, int dur, wf_animation_type type)
     name = "animation-fire-" + std::to_string(type);
     auto tr = std::make_unique<FireTransformer>(view);
     transformer = decltype(transformer)(tr.get());
+    transformer->set_progress_line(this->progression);
+    last_progress_line = this->progression;
 
     view->add_transformer(std::move(tr), name);
 }
 
 bool FireAnimation::step()
 {
+    last_progress_line   = transformer->progress_line;
+    last_particle_bounds = transformer->ps.get_bounding_box();
+
     transformer->set_progress_line(this->progression);
     if (this->progression.running())
     {
@@ -169,6 +180,41 @@ bool FireAnimation::step()
     return this->progression.running() || transformer->ps.statistic();
 }
 
+/* The particles which are still alive after the duration are driven by the
+ * damage of each step */
+wf::animation::duration_t*FireAnimation::get_duration()
+{
+    return &progression;
+}
+
+wf::region_t FireAnimation::get_step_damage(wf::geometry_t before,
+    wf::geometry_t after)
+{
+    /* The view was resized or moved, the particles are now relative to a
+     * different position. */
+    if (before != after)
+    {
+        return animation_base::get_step_damage(before, after);
+    }
+
+    auto view_box = transformer->get_view_box();
+    wf::region_t damage;
+
+    /* The view contents between the old and the new progress line appeared or
+     * disappeared in this step. */
+    const float line = transformer->progress_line;
+    int y1 = view_box.height * std::min(line, last_progress_line) - 1;
+    int y2 = view_box.height * std::max(line, last_progress_line) + 1;
+    damage |= wf::geometry_t{view_box.x, view_box.y + y1, view_box.width, y2 - y1};
+
+    /* The particles have to be cleared at their old positions and drawn at
+     * the new ones. */
+    damage |= last_particle_bounds + wf::origin(view_box);
+    damage |= transformer->ps.get_bounding_box() + wf::origin(view_box);
+
+    return damage & after;
+}
+
 FireAnimation::~FireAnimation()
 {
     view->pop_transformer(name);
@@ -15,11 +15,19 @@ class FireAnimation : public animation_base
     nonstd::observer_ptr<FireTransformer> transformer;
     wf::animation::simple_animation_t progression;
 
+    /* The state at the last step, used to calculate the damage of each step.
+     * The particle bounds are relative to the view. */
+    float last_progress_line = 0;
+    wf::geometry_t last_particle_bounds = {0, 0, 0, 0};
+
   public:
 
     ~FireAnimation();
     void init(wayfire_view view, int duration, wf_animation_type type) override;
     bool step() override; /* return true if continue, false otherwise */
+    wf::region_t get_step_damage(wf::geometry_t before,
+        wf::geometry_t after) override;
+    wf::animation::duration_t *get_duration() override;
 };
 
 #endif /* end of include guard: FIRE_ANIMATION_HPP */
@@ -2,6 +2,7 @@
 #include "shaders.hpp"
 #include <wayfire/core.hpp>
 #include <thread>
+#include <cmath>
 
 void Particle::update(float time)
 {
@@ -175,6 +176,34 @@ int ParticleSystem::statistic()
     return particles_alive;
 }
 
+wf::geometry_t ParticleSystem::get_bounding_box()
+{
+    float x1 = 1e9, y1 = 1e9, x2 = -1e9, y2 = -1e9;
+    for (auto& p : ps)
+    {
+        if (p.life <= 0)
+        {
+            continue;
+        }
+
+        x1 = std::min(x1, p.pos.x - p.radius);
+        y1 = std::min(y1, p.pos.y - p.radius);
+        x2 = std::max(x2, p.pos.x + p.radius);
+        y2 = std::max(y2, p.pos.y + p.radius);
+    }
+
+    if ((x1 > x2) || (y1 > y2))
+    {
+        return {0, 0, 0, 0};
+    }
+
+    /* Round outwards, so that the edges of the particles are included */
+    int ix = std::floor(x1) - 1;
+    int iy = std::floor(y1) - 1;
+
+    return {ix, iy, (int)std::ceil(x2) + 1 - ix, (int)std::ceil(y2) + 1 - iy};
+}
+
 void ParticleSystem::create_program()
 {
     /* Just load the proper context, viewport doesn't matter */
@@ -53,6 +53,11 @@ class ParticleSystem
     // number of particles alive
     int statistic();
 
+    /* get the smallest box containing all alive particles, in the coordinate
+     * system of the particles. An empty box is returned if no particles are
+     * alive. */
+    wf::geometry_t get_bounding_box();
+
     /* render particles, each will be multiplied by matrix
      * The user of this class has to set up the same GL context that was
      * used during the creation of the particle system */
@@ -28,8 +28,8 @@ class wf_system_fade
 
         output->render->add_effect(&damage_hook, wf::OUTPUT_EFFECT_PRE);
         output->render->add_effect(&render_hook, wf::OUTPUT_EFFECT_OVERLAY);
-        output->render->set_redraw_always();
         this->progression.animate(1, 0);
+        output->render->add_animation(&progression);
     }
 
     void render()
@@ -53,7 +53,7 @@ class wf_system_fade
     {
         output->render->rem_effect(&damage_hook);
         output->render->rem_effect(&render_hook);
-        output->render->set_redraw_always(false);
+        output->render->rem_animation(&progression);
 
         delete this;
     }
@@ -277,6 +277,11 @@ class output_data_t : public noncopyable_t, public custom_data_t
 
         this->output = output;
         this->views  = views;
+
+        for (auto& view : this->views)
+        {
+            view.view->connect_signal("region-damaged", &on_view_damaged);
+        }
     }
 
     ~output_data_t()
@@ -285,19 +290,12 @@ class output_data_t : public noncopyable_t, public custom_data_t
         output->render->rem_effect(&render_overlay);
     }
 
+    /** Damage the current and the last bounding box of all dragged views. */
     void apply_damage()
     {
         for (auto& view : views)
         {
-            // Note: bbox will be in output layout coordinates now, since this is
-            // how the transformer works
-            auto bbox = view.view->get_bounding_box();
-            bbox = bbox + -wf::origin(output->get_layout_geometry());
-
-            output->render->damage(bbox);
-            output->render->damage(view.last_bbox);
-
-            view.last_bbox = bbox;
+            damage_view(view);
         }
     }
 
@@ -306,18 +304,53 @@ class output_data_t : public noncopyable_t, public custom_data_t
 
     std::vector<dragged_view_t> views;
 
+    // Set when any of the dragged views received damage since the last frame,
+    // for ex. because the client committed a new buffer or wobbly moved.
+    bool views_damaged = true;
+
+    void damage_view(dragged_view_t& view)
+    {
+        // Note: bbox will be in output layout coordinates now, since this is
+        // how the transformer works
+        auto bbox = view.view->get_bounding_box();
+        bbox = bbox + -wf::origin(output->get_layout_geometry());
+
+        output->render->damage(bbox);
+        output->render->damage(view.last_bbox);
+
+        view.last_bbox = bbox;
+    }
+
+    wf::signal_connection_t on_view_damaged = [=] (wf::signal_data_t*)
+    {
+        views_damaged = true;
+    };
+
     // An effect hook for damaging the view on the current output.
     //
     // This is needed on a per-output basis in order to drive the scaling animation
     // forward, if such an animation is running.
     //
-    // TODO: We overdo damage, for ex. in the following cases:
-    // - Expo does not need any damage (can't really be fixed, since we don't know
-    // the plugin which uses this API).
-    // - If the view has not updated, and cursor has not moved
+    // Views are damaged only if they moved (i.e the cursor moved), they are
+    // being scaled, or their contents changed. Plugins like expo which do not
+    // need the damage at all still get it, since we do not know which plugin
+    // uses this API.
     effect_hook_t damage_overlay = [=] ()
     {
-        apply_damage();
+        const bool contents_changed = views_damaged;
+        views_damaged = false;
+
+        for (auto& view : views)
+        {
+            auto bbox = view.view->get_bounding_box() +
+                -wf::origin(output->get_layout_geometry());
+
+            if (contents_changed || (bbox != view.last_bbox) ||
+                view.transformer->scale_factor.running())
+            {
+                damage_view(view);
+            }
+        }
     };
 
     effect_hook_t render_overlay = [=] ()
@@ -325,15 +358,20 @@ class output_data_t : public noncopyable_t, public custom_data_t
         auto fb = output->render->get_target_framebuffer();
         fb.geometry = output->get_layout_geometry();
 
+        // Repaint only the parts of the views which are damaged in this frame.
+        // The frame damage includes the damage accumulated for the current
+        // buffer, so everything else on screen is still up-to-date.
+        auto frame_damage = output->render->get_scheduled_damage();
         for (auto& view : wf::reverse(views))
         {
             // Convert damage from output-local coordinates (last_bbox) to
             // output-layout coords.
-            wf::region_t damage;
-            damage |= view.last_bbox + wf::origin(fb.geometry);
+            auto damage = (frame_damage & view.last_bbox) + wf::origin(fb.geometry);
+            if (damage.empty())
+            {
+                continue;
+            }
 
-            // Render the full view, always
-            // Not very efficient
             view.view->render_transformed(fb, std::move(damage));
         }
     };
@@ -501,6 +539,16 @@ class core_drag_t : public signal_provider_t
             }
         }
 
+        // Damage the old and the new position right away, the pre-frame hook
+        // only runs once a frame has been scheduled.
+        for (auto& output : wf::get_core().output_layout->get_outputs())
+        {
+            if (auto data = output->get_data<output_data_t>())
+            {
+                data->apply_damage();
+            }
+        }
+
         update_current_output(to);
     }
 
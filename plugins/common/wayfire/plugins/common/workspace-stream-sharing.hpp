@@ -77,13 +77,17 @@ class workspace_stream_pool_t : public noncopyable_t, public wf::custom_data_t
      * Update the contents of the given workspace.
      *
      * If the workspace has not been started before, it will be started.
+     *
+     * @param scale_x The fraction of the output width at which the workspace
+     *   is displayed, see render_manager::workspace_stream_update().
+     * @param scale_y Like scale_x, for the output height.
      */
-    void update(wf::point_t workspace)
+    void update(wf::point_t workspace, float scale_x = 1, float scale_y = 1)
     {
         auto& stream = get(workspace);
         if (stream.running)
         {
-            output->render->workspace_stream_update(stream);
+            output->render->workspace_stream_update(stream, scale_x, scale_y);
         } else
         {
             output->render->workspace_stream_start(stream);
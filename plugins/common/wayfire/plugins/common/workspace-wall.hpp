@@ -102,7 +102,7 @@ class workspace_wall_t : public wf::signal_provider_t
      */
     void render_wall(const wf::framebuffer_t& fb, wf::geometry_t geometry)
     {
-        update_streams();
+        update_streams(geometry);
 
         OpenGL::render_begin(fb);
         fb.logic_scissor(geometry);
@@ -203,12 +203,23 @@ class workspace_wall_t : public wf::signal_provider_t
     wf::geometry_t viewport = {0, 0, 0, 0};
     nonstd::observer_ptr<workspace_stream_pool_t> streams;
 
-    /** Update or start visible streams */
-    void update_streams()
+    /**
+     * Update or start visible streams.
+     *
+     * @param geometry The rectangle the viewport is rendered to.
+     */
+    void update_streams(wf::geometry_t geometry)
     {
+        float scale_x = 1, scale_y = 1;
+        if ((viewport.width > 0) && (viewport.height > 0))
+        {
+            scale_x = 1.0 * geometry.width / viewport.width;
+            scale_y = 1.0 * geometry.height / viewport.height;
+        }
+
         for (auto& ws : get_visible_workspaces(viewport))
         {
-            streams->update(ws);
+            streams->update(ws, scale_x, scale_y);
         }
     }
 
@@ -252,9 +252,8 @@ class wayfire_cube : public wf::plugin_interface_t
         animation.cube_animation.offset_y.set(0, 0);
         animation.cube_animation.offset_z.set(offset_z, offset_z);
 
-        animation.cube_animation.start();
+        start_animation();
         update_view_matrix();
-        output->render->schedule_redraw();
     }
 
     /* Tries to initialize renderer, activate plugin, etc. */
@@ -279,6 +278,13 @@ class wayfire_cube : public wf::plugin_interface_t
         return true;
     }
 
+    /* Start the animation, the frame clock repaints until it has finished */
+    void start_animation()
+    {
+        animation.cube_animation.start();
+        output->render->add_animation(&animation.cube_animation);
+    }
+
     int calculate_viewport_dx_from_rotation()
     {
         float dx = -animation.cube_animation.rotation / animation.side_angle;
@@ -351,9 +357,8 @@ class wayfire_cube : public wf::plugin_interface_t
         animation.cube_animation.rotation.restart_with_end(
             animation.cube_animation.rotation.end - dir * animation.side_angle);
 
-        animation.cube_animation.start();
+        start_animation();
         update_view_matrix();
-        output->render->schedule_redraw();
 
         return true;
     }
@@ -384,10 +389,9 @@ class wayfire_cube : public wf::plugin_interface_t
         animation.cube_animation.zoom.set(current_zoom, current_zoom);
         animation.cube_animation.ease_deformation.restart_with_end(1);
 
-        animation.cube_animation.start();
+        start_animation();
 
         update_view_matrix();
-        output->render->schedule_redraw();
 
         return true;
     }
@@ -406,10 +410,9 @@ class wayfire_cube : public wf::plugin_interface_t
          * */
         reset_attribs();
 
-        animation.cube_animation.start();
+        start_animation();
 
         update_view_matrix();
-        output->render->schedule_redraw();
     }
 
     /* Update the view matrix used in the next frame */
@@ -561,10 +564,7 @@ class wayfire_cube : public wf::plugin_interface_t
 
         update_view_matrix();
 
-        if (animation.cube_animation.running())
-        {
-            output->render->schedule_redraw();
-        } else if (animation.in_exit)
+        if (!animation.cube_animation.running() && animation.in_exit)
         {
             deactivate();
         }
@@ -611,8 +611,7 @@ class wayfire_cube : public wf::plugin_interface_t
         animation.cube_animation.ease_deformation.restart_with_end(
             animation.cube_animation.ease_deformation.end);
 
-        animation.cube_animation.start();
-        output->render->schedule_redraw();
+        start_animation();
     }
 
     void pointer_scrolled(double amount)
@@ -639,8 +638,7 @@ class wayfire_cube : public wf::plugin_interface_t
         target_zoom = std::min(std::max(target_zoom, ZOOM_MIN), ZOOM_MAX);
         animation.cube_animation.zoom.set(start_zoom, target_zoom);
 
-        animation.cube_animation.start();
-        output->render->schedule_redraw();
+        start_animation();
     }
 
     void fini() override
@@ -650,6 +648,7 @@ class wayfire_cube : public wf::plugin_interface_t
             deactivate();
         }
 
+        output->render->rem_animation(&animation.cube_animation);
         streams->unref();
 
         OpenGL::render_begin();
@@ -1,6 +1,7 @@
 #include <cctype>
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <wayfire/plugin.hpp>
 #include <wayfire/singleton-plugin.hpp>
 #include <wayfire/output.hpp>
@@ -101,6 +102,7 @@ class scale_title_filter : public wf::singleton_plugin_t<scale_title_filter_text
 {
     wf::option_wrapper_t<bool> case_sensitive{"scale-title-filter/case_sensitive"};
     wf::option_wrapper_t<bool> share_filter{"scale-title-filter/share_filter"};
+    wf::option_wrapper_t<bool> fuzzy{"scale-title-filter/fuzzy"};
     scale_title_filter_text local_filter;
 
     inline void fix_case(std::string& string)
@@ -122,24 +124,176 @@ class scale_title_filter : public wf::singleton_plugin_t<scale_title_filter_text
         std::transform(string.begin(), string.end(), string.begin(), transform);
     }
 
-    bool should_show_view(wayfire_view view)
+    /**
+     * Cached, case-folded title and app-id of a view, so that typing does not
+     * need to fold every title again on each key press.
+     */
+    struct view_entry_t
     {
-        auto filter = get_active_filter().title_filter;
+        /* the original strings, used to detect title changes */
+        std::string title, app_id;
+        /* folded title and app-id, separated by a NUL byte so that matches
+         * cannot span both */
+        std::string text;
+        /* distinct trigrams of text, used for fuzzy matching */
+        std::vector<uint32_t> trigrams;
+        /* whether the view matches matched_filter */
+        bool shown = true;
+    };
+
+    std::map<wayfire_view, view_entry_t> entries;
+    /* trigram -> views containing it, rebuilt lazily when entries change */
+    std::unordered_map<uint32_t, std::vector<wayfire_view>> trigram_index;
+    bool index_dirty = true;
+    /* the filter the shown flags in entries correspond to */
+    std::string matched_filter;
+    bool matches_dirty = true;
 
-        if (filter.empty())
+    static uint32_t make_trigram(const std::string& s, size_t i)
+    {
+        return ((uint32_t)(unsigned char)s[i] << 16) |
+               ((uint32_t)(unsigned char)s[i + 1] << 8) |
+               (uint32_t)(unsigned char)s[i + 2];
+    }
+
+    static std::vector<uint32_t> get_trigrams(const std::string& s)
+    {
+        std::vector<uint32_t> result;
+        for (size_t i = 0; i + 2 < s.length(); i++)
         {
-            return true;
+            result.push_back(make_trigram(s, i));
         }
 
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+    /**
+     * Update the cached strings of the view if its title or app-id changed.
+     *
+     * @return The entry of the view.
+     */
+    view_entry_t& refresh_entry(wayfire_view view)
+    {
         auto title  = view->get_title();
         auto app_id = view->get_app_id();
 
+        auto it = entries.find(view);
+        if ((it != entries.end()) && (it->second.title == title) &&
+            (it->second.app_id == app_id))
+        {
+            return it->second;
+        }
+
+        auto& entry = entries[view];
+        entry.title  = title;
+        entry.app_id = app_id;
         fix_case(title);
         fix_case(app_id);
+        entry.text = title + '\0' + app_id;
+        entry.trigrams = get_trigrams(entry.text);
+
+        index_dirty   = true;
+        matches_dirty = true;
+        return entry;
+    }
+
+    void rebuild_trigram_index()
+    {
+        trigram_index.clear();
+        for (auto& [view, entry] : entries)
+        {
+            for (auto t : entry.trigrams)
+            {
+                trigram_index[t].push_back(view);
+            }
+        }
+
+        index_dirty = false;
+    }
+
+    void clear_entries()
+    {
+        entries.clear();
+        trigram_index.clear();
+        index_dirty   = true;
+        matches_dirty = true;
+    }
+
+    /**
+     * Recompute the shown flag of the cached views for the active filter.
+     *
+     * When characters were only appended to the filter, views which did not
+     * match before cannot match now, so only the views shown so far are tested.
+     *
+     * @return Whether the visibility of any view changed.
+     */
+    bool update_matches()
+    {
+        auto filter = get_active_filter().title_filter;
         fix_case(filter);
+        if (!matches_dirty && (filter == matched_filter))
+        {
+            return false;
+        }
+
+        bool narrowing = !matches_dirty && !fuzzy &&
+            (filter.compare(0, matched_filter.length(), matched_filter) == 0);
+
+        /* In fuzzy mode, a view matches if it contains the filter, or if it
+         * contains at least two thirds of the trigrams of the filter. The
+         * number of matching trigrams is counted from the trigram index, so
+         * views sharing nothing with the filter are never looked at. */
+        std::map<wayfire_view, size_t> trigram_hits;
+        size_t needed_hits = 0;
+        if (fuzzy && (filter.length() >= 3))
+        {
+            if (index_dirty)
+            {
+                rebuild_trigram_index();
+            }
+
+            auto filter_trigrams = get_trigrams(filter);
+            needed_hits = (2 * filter_trigrams.size() + 2) / 3;
+            for (auto t : filter_trigrams)
+            {
+                auto it = trigram_index.find(t);
+                if (it == trigram_index.end())
+                {
+                    continue;
+                }
+
+                for (auto& view : it->second)
+                {
+                    ++trigram_hits[view];
+                }
+            }
+        }
+
+        bool changed = false;
+        for (auto& [view, entry] : entries)
+        {
+            if (narrowing && !entry.shown)
+            {
+                continue;
+            }
 
-        return (title.find(filter) != std::string::npos) ||
-               (app_id.find(filter) != std::string::npos);
+            bool shown = filter.empty() ||
+                (entry.text.find(filter) != std::string::npos);
+            if (!shown && (needed_hits > 0))
+            {
+                auto it = trigram_hits.find(view);
+                shown = (it != trigram_hits.end()) && (it->second >= needed_hits);
+            }
+
+            changed |= (shown != entry.shown);
+            entry.shown = shown;
+        }
+
+        matched_filter = filter;
+        matches_dirty  = false;
+        return changed;
     }
 
     scale_title_filter_text& get_active_filter()
@@ -166,8 +320,11 @@ class scale_title_filter : public wf::singleton_plugin_t<scale_title_filter_text
         grab_interface->capabilities = 0;
 
         share_filter.set_callback(shared_option_changed);
+        case_sensitive.set_callback(match_option_changed);
+        fuzzy.set_callback(match_option_changed);
         output->connect_signal("scale-filter", &view_filter);
         output->connect_signal("scale-end", &scale_end);
+        output->connect_signal("view-disappeared", &view_disappeared);
     }
 
     void fini() override
@@ -190,13 +347,28 @@ class scale_title_filter : public wf::singleton_plugin_t<scale_title_filter_text
             }
 
             auto signal = static_cast<scale_filter_signal*>(data);
+            for (auto& view : signal->views_shown)
+            {
+                refresh_entry(view);
+            }
+
+            update_matches();
             scale_filter_views(signal, [this] (wayfire_view v)
             {
-                return !should_show_view(v);
+                return !entries[v].shown;
             });
         }
     };
 
+    wf::signal_connection_t view_disappeared{[this] (wf::signal_data_t *data)
+        {
+            if (entries.erase(wf::get_signaled_view(data)))
+            {
+                index_dirty = true;
+            }
+        }
+    };
+
     std::map<uint32_t, std::unique_ptr<scale_key_repeat_t>> keys;
     scale_key_repeat_t::callback_t handle_key_repeat = [=] (uint32_t raw_keycode)
     {
@@ -222,11 +394,23 @@ class scale_title_filter : public wf::singleton_plugin_t<scale_title_filter_text
 
     void update_filter()
     {
-        if (scale_running)
+        if (!scale_running)
+        {
+            return;
+        }
+
+        for (auto& [view, entry] : entries)
+        {
+            refresh_entry(view);
+        }
+
+        /* scale needs to relayout only if some view was hidden or shown */
+        if (update_matches())
         {
             output->emit_signal("scale-update", nullptr);
-            update_overlay();
         }
+
+        update_overlay();
     }
 
     wf::signal_connection_t scale_key = [this] (wf::signal_data_t *data)
@@ -266,6 +450,7 @@ class scale_title_filter : public wf::singleton_plugin_t<scale_title_filter_text
         wf::get_core().disconnect_signal(&scale_key);
         keys.clear();
         clear_overlay();
+        clear_entries();
         scale_running = false;
         get_active_filter().check_scale_end();
     }
@@ -277,11 +462,21 @@ class scale_title_filter : public wf::singleton_plugin_t<scale_title_filter_text
             /* clear the filter that is not used anymore */
             auto& filter = share_filter ? local_filter : get_instance();
             filter.clear();
+            matches_dirty = true;
             output->emit_signal("scale-update", nullptr);
             update_overlay();
         }
     };
 
+    wf::config::option_base_t::updated_callback_t match_option_changed = [this] ()
+    {
+        clear_entries();
+        if (scale_running)
+        {
+            output->emit_signal("scale-update", nullptr);
+        }
+    };
+
   protected:
     /*
      * Text overlay with the current filter
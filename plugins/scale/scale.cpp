@@ -54,6 +54,26 @@ struct view_scale_data
     };
 
     view_visibility_t visibility = view_visibility_t::VISIBLE;
+
+    /* The output whose frame clock drives the animations */
+    wf::output_t *animation_output = nullptr;
+
+    /* Let the output repaint until the animations have finished */
+    void drive_animations(wf::output_t *output)
+    {
+        animation_output = output;
+        output->render->add_animation(&fade_animation);
+        output->render->add_animation(&animation.scale_animation);
+    }
+
+    ~view_scale_data()
+    {
+        if (animation_output)
+        {
+            animation_output->render->rem_animation(&fade_animation);
+            animation_output->render->rem_animation(&animation.scale_animation);
+        }
+    }
 };
 
 class wayfire_scale : public wf::plugin_interface_t
@@ -397,6 +417,7 @@ class wayfire_scale : public wf::plugin_interface_t
         set_hook();
         auto alpha = scale_data[view].transformer->alpha;
         scale_data[view].fade_animation.animate(alpha, 1);
+        scale_data[view].drive_animations(output);
         if (view->children.size())
         {
             fade_in(view->children.front());
@@ -422,6 +443,7 @@ class wayfire_scale : public wf::plugin_interface_t
 
             auto alpha = scale_data[v].transformer->alpha;
             scale_data[v].fade_animation.animate(alpha, (double)inactive_alpha);
+            scale_data[v].drive_animations(output);
         }
     }
 
@@ -843,6 +865,7 @@ class wayfire_scale : public wf::plugin_interface_t
             wf::option_wrapper_t<int>{"scale/duration"});
         view_data.fade_animation.animate(view_data.transformer->alpha,
             target_alpha);
+        view_data.drive_animations(output);
     }
 
     static bool view_compare_x(const wayfire_view& a, const wayfire_view& b)
@@ -1267,17 +1290,10 @@ class wayfire_scale : public wf::plugin_interface_t
         transform_views();
     };
 
-    /* Keep rendering until all animation has finished */
+    /* The frame clock keeps rendering until all animations have finished */
     wf::effect_hook_t post_hook = [=] ()
     {
-        bool running = animation_running();
-
-        if (running)
-        {
-            output->render->schedule_redraw();
-        }
-
-        if (active || running)
+        if (active || animation_running())
         {
             return;
         }
@@ -298,7 +298,7 @@ class wayfire_expo : public wf::plugin_interface_t
         zoom_animation.start();
         wall->set_viewport(zoom_animation);
         wall->start_output_renderer();
-        output->render->schedule_redraw();
+        output->render->add_animation(&zoom_animation);
     }
 
     void deactivate()
@@ -510,7 +510,6 @@ class wayfire_expo : public wf::plugin_interface_t
         {
             if (zoom_animation.running())
             {
-                output->render->schedule_redraw();
                 wall->set_viewport(zoom_animation);
             } else if (!state.zoom_in)
             {
@@ -539,6 +538,7 @@ class wayfire_expo : public wf::plugin_interface_t
             finalize_and_exit();
         }
 
+        output->render->rem_animation(&zoom_animation);
         output->rem_binding(&toggle_cb);
     }
 };
@@ -166,6 +166,7 @@ class wayfire_grid_view_cdata : public wf::custom_data_t
         animation.set_start(original);
         animation.set_end(geometry);
         animation.start();
+        output->render->add_animation(&animation, view);
 
         // Add crossfade transformer
         if (!view->get_transformer("grid-crossfade"))
@@ -215,6 +216,7 @@ class wayfire_grid_view_cdata : public wf::custom_data_t
     {
         view->pop_transformer("grid-crossfade");
         output->render->rem_effect(&pre_hook);
+        output->render->rem_animation(&animation);
     }
 };
 
@@ -322,7 +322,7 @@ class wayfire_idle_singleton : public wf::singleton_plugin_t<wayfire_idle>
     wf::effect_hook_t screensaver_frame = [=] ()
     {
         cube_control_signal data;
-        uint32_t current = wf::get_current_time();
+        uint32_t current = output->render->get_frame_time();
         uint32_t elapsed = current - last_time;
 
         last_time = current;
@@ -399,7 +399,7 @@ class wayfire_idle_singleton : public wf::singleton_plugin_t<wayfire_idle>
         screensaver_animation.zoom.set(CUBE_ZOOM_BASE, cube_max_zoom);
         screensaver_animation.ease.set(0.0, 1.0);
         screensaver_animation.start();
-        last_time = wf::get_current_time();
+        last_time = output->render->get_frame_time();
     }
 
     void stop_screensaver()
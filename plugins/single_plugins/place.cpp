@@ -4,6 +4,153 @@
 #include <wayfire/workspace-manager.hpp>
 #include <wayfire/signal-definitions.hpp>
 
+#include <algorithm>
+#include <tuple>
+
+/**
+ * A uniform grid over the workarea, where each cell holds the windows which
+ * intersect it. It is used to find the windows overlapping a given rectangle
+ * without checking every window on the workspace.
+ *
+ * The grid also sums up how much of each cell is covered by windows, which
+ * gives a cheap lower bound for the overlap of a rectangle.
+ */
+class window_grid_t
+{
+  public:
+    window_grid_t(wf::geometry_t area, std::vector<wf::geometry_t> windows)
+    {
+        this->area    = area;
+        this->windows = std::move(windows);
+        this->cell_width  = std::max(1, (area.width + GRID_SIZE - 1) / GRID_SIZE);
+        this->cell_height = std::max(1, (area.height + GRID_SIZE - 1) / GRID_SIZE);
+
+        cells.resize(GRID_SIZE * GRID_SIZE);
+        visited.resize(this->windows.size(), 0);
+
+        std::vector<int64_t> coverage(GRID_SIZE * GRID_SIZE, 0);
+        for (int i = 0; i < (int)this->windows.size(); i++)
+        {
+            for_each_cell(this->windows[i], [&] (std::vector<int>& cell)
+            {
+                cell.push_back(i);
+
+                int index = &cell - cells.data();
+                auto common = wf::geometry_intersection(this->windows[i],
+                    get_cell(index % GRID_SIZE, index / GRID_SIZE));
+                coverage[index] += (int64_t)common.width * common.height;
+            });
+        }
+
+        /* covered_sum[y][x] is the coverage of all cells above and left of (x, y) */
+        covered_sum.assign((GRID_SIZE + 1) * (GRID_SIZE + 1), 0);
+        for (int y = 0; y < GRID_SIZE; y++)
+        {
+            for (int x = 0; x < GRID_SIZE; x++)
+            {
+                sum_at(x + 1, y + 1) = coverage[y * GRID_SIZE + x] +
+                    sum_at(x, y + 1) + sum_at(x + 1, y) - sum_at(x, y);
+            }
+        }
+    }
+
+    /**
+     * @return A lower bound for get_overlap(@rect) in constant time: the
+     *   coverage of the cells which lie completely inside @rect.
+     */
+    int64_t get_overlap_bound(wf::geometry_t rect)
+    {
+        auto first_cell = [] (int coordinate, int start, int size)
+        {
+            return wf::clamp((coordinate - start + size - 1) / size, 0, GRID_SIZE);
+        };
+        auto end_cell = [] (int coordinate, int start, int size)
+        {
+            return wf::clamp((coordinate - start) / size, 0, GRID_SIZE);
+        };
+
+        int x1 = first_cell(rect.x, area.x, cell_width);
+        int x2 = end_cell(rect.x + rect.width, area.x, cell_width);
+        int y1 = first_cell(rect.y, area.y, cell_height);
+        int y2 = end_cell(rect.y + rect.height, area.y, cell_height);
+        if ((x1 >= x2) || (y1 >= y2))
+        {
+            return 0;
+        }
+
+        return sum_at(x2, y2) - sum_at(x1, y2) - sum_at(x2, y1) + sum_at(x1, y1);
+    }
+
+    /** @return The total area of @rect covered by windows in the grid. */
+    int64_t get_overlap(wf::geometry_t rect)
+    {
+        ++stamp;
+        int64_t overlap = 0;
+        for_each_cell(rect, [&] (std::vector<int>& cell)
+        {
+            for (int i : cell)
+            {
+                if (visited[i] == stamp)
+                {
+                    continue;
+                }
+
+                visited[i] = stamp;
+                auto common = wf::geometry_intersection(rect, windows[i]);
+                overlap += (int64_t)common.width * common.height;
+            }
+        });
+
+        return overlap;
+    }
+
+  private:
+    static constexpr int GRID_SIZE = 16;
+
+    wf::geometry_t area;
+    int cell_width, cell_height;
+
+    std::vector<wf::geometry_t> windows;
+    std::vector<std::vector<int>> cells;
+    std::vector<int64_t> covered_sum;
+
+    /* Used to count each window once per query */
+    std::vector<uint32_t> visited;
+    uint32_t stamp = 0;
+
+    int64_t& sum_at(int x, int y)
+    {
+        return covered_sum[y * (GRID_SIZE + 1) + x];
+    }
+
+    wf::geometry_t get_cell(int x, int y) const
+    {
+        return {area.x + x * cell_width, area.y + y * cell_height,
+            cell_width, cell_height};
+    }
+
+    template<class Callback>
+    void for_each_cell(wf::geometry_t rect, Callback call)
+    {
+        auto to_cell = [] (int coordinate, int start, int size)
+        {
+            return wf::clamp((coordinate - start) / size, 0, GRID_SIZE - 1);
+        };
+
+        int x1 = to_cell(rect.x, area.x, cell_width);
+        int x2 = to_cell(rect.x + rect.width - 1, area.x, cell_width);
+        int y1 = to_cell(rect.y, area.y, cell_height);
+        int y2 = to_cell(rect.y + rect.height - 1, area.y, cell_height);
+        for (int y = y1; y <= y2; y++)
+        {
+            for (int x = x1; x <= x2; x++)
+            {
+                call(cells[y * GRID_SIZE + x]);
+            }
+        }
+    }
+};
+
 class wayfire_place_window : public wf::plugin_interface_t
 {
     wf::signal_connection_t created_cb = [=] (wf::signal_data_t *data)
@@ -30,6 +177,9 @@ class wayfire_place_window : public wf::plugin_interface_t
         } else if (mode == "random")
         {
             random(view, workarea);
+        } else if (mode == "minimal_overlap")
+        {
+            minimal_overlap(view, workarea);
         } else
         {
             center(view, workarea);
@@ -56,6 +206,9 @@ class wayfire_place_window : public wf::plugin_interface_t
 
     int cascade_x, cascade_y;
 
+    /* Upper limit for the exact overlap computations of one placement */
+    static constexpr int MAX_OVERLAP_QUERIES = 256;
+
   public:
     void init() override
     {
@@ -108,6 +261,118 @@ class wayfire_place_window : public wf::plugin_interface_t
         view->move(pos_x, pos_y);
     }
 
+    /**
+     * Place the view where it overlaps the least with the other windows on the
+     * current workspace.
+     *
+     * The candidate positions are the edges of the workarea and the positions
+     * where the view touches the edges of other windows. With n windows, there
+     * are O(n^2) of them, so they are first ranked by the constant time lower
+     * bound of the grid. The exact overlap is then computed in that order, until
+     * the bound cannot beat the best candidate anymore, a free spot is found,
+     * or MAX_OVERLAP_QUERIES have been made.
+     *
+     * Ranking the candidates takes O(n^2 log n) time. Only the number of exact
+     * overlap queries is bounded.
+     */
+    void minimal_overlap(wayfire_view & view, wf::geometry_t workarea)
+    {
+        wf::geometry_t window = view->get_wm_geometry();
+        if ((window.width > workarea.width) || (window.height > workarea.height))
+        {
+            center(view, workarea);
+
+            return;
+        }
+
+        std::vector<wf::geometry_t> others;
+        std::vector<int> xs = {workarea.x,
+            workarea.x + workarea.width - window.width};
+        std::vector<int> ys = {workarea.y,
+            workarea.y + workarea.height - window.height};
+
+        auto ws = output->workspace->get_current_workspace();
+        for (auto& other :
+             output->workspace->get_views_on_workspace(ws, wf::LAYER_WORKSPACE))
+        {
+            if ((other == view) || !other->is_mapped() || other->minimized)
+            {
+                continue;
+            }
+
+            auto g = other->get_wm_geometry();
+            others.push_back(g);
+            xs.push_back(g.x + g.width);
+            xs.push_back(g.x - window.width);
+            ys.push_back(g.y + g.height);
+            ys.push_back(g.y - window.height);
+        }
+
+        /* Keep only positions where the view fits inside the workarea */
+        auto filter = [] (std::vector<int>& v, int min, int max)
+        {
+            v.erase(std::remove_if(v.begin(), v.end(),
+                [=] (int c) { return c < min || c > max; }), v.end());
+            std::sort(v.begin(), v.end());
+            v.erase(std::unique(v.begin(), v.end()), v.end());
+        };
+        filter(xs, workarea.x, workarea.x + workarea.width - window.width);
+        filter(ys, workarea.y, workarea.y + workarea.height - window.height);
+
+        window_grid_t grid{workarea, std::move(others)};
+
+        struct candidate_t
+        {
+            int64_t bound;
+            int y, x;
+        };
+
+        /* Ties are broken top to bottom, left to right */
+        std::vector<candidate_t> candidates;
+        candidates.reserve(xs.size() * ys.size());
+        for (int y : ys)
+        {
+            for (int x : xs)
+            {
+                candidates.push_back({grid.get_overlap_bound(
+                    {x, y, window.width, window.height}), y, x});
+            }
+        }
+
+        std::sort(candidates.begin(), candidates.end(),
+            [] (const candidate_t& a, const candidate_t& b)
+        {
+            return std::tie(a.bound, a.y, a.x) < std::tie(b.bound, b.y, b.x);
+        });
+
+        wf::point_t best = {candidates.front().x, candidates.front().y};
+        int64_t best_overlap = -1;
+        int queries = 0;
+        for (auto& candidate : candidates)
+        {
+            if (((best_overlap >= 0) && (candidate.bound >= best_overlap)) ||
+                (queries++ >= MAX_OVERLAP_QUERIES))
+            {
+                break;
+            }
+
+            auto overlap = grid.get_overlap(
+                {candidate.x, candidate.y, window.width, window.height});
+            if ((best_overlap < 0) || (overlap < best_overlap))
+            {
+                best_overlap = overlap;
+                best = {candidate.x, candidate.y};
+            }
+
+            if (best_overlap == 0)
+            {
+                break;
+            }
+        }
+
+        view->move(best.x, best.y);
+    }
+
     void center(wayfire_view & view, wf::geometry_t workarea)
     {
         wf::geometry_t window = view->get_wm_geometry();
@@ -19,7 +19,6 @@
 #include <set>
 
 constexpr const char *switcher_transformer = "switcher-3d";
-constexpr const char *switcher_transformer_background = "switcher-3d";
 constexpr float background_dim_factor = 0.6;
 
 using namespace wf::animation;
@@ -102,6 +101,16 @@ class WayfireSwitcher : public wf::plugin_interface_t
     uint32_t activating_modifiers = 0;
     bool active = false;
 
+    // Whether the last frame after the animations has been rendered
+    bool animation_done = true;
+
+    /* The background views, rendered without dimming. The dimming is applied
+     * when the cache is painted, so the cache needs to be updated only when the
+     * background views change. */
+    wf::framebuffer_t background_cache;
+    std::vector<wayfire_view> cached_background_views;
+    bool background_dirty = true;
+
   public:
 
     void init() override
@@ -138,11 +147,36 @@ class WayfireSwitcher : public wf::plugin_interface_t
         return handle_switch_request(1);
     };
 
+    /* Damage the output while the animations are running. The frame clock
+     * repaints once more after they are done, which has to be damaged too so
+     * that the renderer can clean up. After that we repaint only on damage. */
     wf::effect_hook_t damage = [=] ()
+    {
+        if (duration.running() || background_dim_duration.running())
+        {
+            animation_done = false;
+            output->render->damage_whole();
+        } else if (!animation_done)
+        {
+            animation_done = true;
+            output->render->damage_whole();
+        }
+    };
+
+    /* A view might be visible on more than 1 place, so damage tracking
+     * for the switcher views doesn't work reliably. To circumvent this, we
+     * simply damage the whole output when any of them changes. */
+    wf::signal_connection_t on_view_damaged = [=] (wf::signal_data_t*)
     {
         output->render->damage_whole();
     };
 
+    wf::signal_connection_t on_background_damaged = [=] (wf::signal_data_t*)
+    {
+        background_dirty = true;
+        output->render->damage_whole();
+    };
+
     wf::signal_callback_t view_removed = [=] (wf::signal_data_t *data)
     {
         handle_view_removed(get_signaled_view(data));
@@ -234,11 +268,17 @@ class WayfireSwitcher : public wf::plugin_interface_t
 
         output->render->add_effect(&damage, wf::OUTPUT_EFFECT_PRE);
         output->render->set_renderer(switcher_renderer);
-        output->render->set_redraw_always();
 
         return true;
     }
 
+    /* Start the animation, the frame clock repaints until it has finished */
+    void start_animation(duration_t& animation)
+    {
+        animation.start();
+        output->render->add_animation(&animation);
+    }
+
     /* The reverse of init_switcher */
     void deinit_switcher()
     {
@@ -246,12 +286,20 @@ class WayfireSwitcher : public wf::plugin_interface_t
 
         output->render->rem_effect(&damage);
         output->render->set_renderer(nullptr);
-        output->render->set_redraw_always(false);
+
+        on_view_damaged.disconnect();
+        on_background_damaged.disconnect();
+        cached_background_views.clear();
+        background_dirty = true;
+        animation_done   = true;
+
+        OpenGL::render_begin();
+        background_cache.release();
+        OpenGL::render_end();
 
         for (auto& view : output->workspace->get_views_in_layer(wf::ALL_LAYERS))
         {
             view->pop_transformer(switcher_transformer);
-            view->pop_transformer(switcher_transformer_background);
         }
 
         views.clear();
@@ -430,9 +478,10 @@ class WayfireSwitcher : public wf::plugin_interface_t
         // clear views in case that deinit() hasn't been run
         views.clear();
 
-        duration.start();
+        start_animation(duration);
         background_dim.set(1, background_dim_factor);
-        background_dim_duration.start();
+        start_animation(background_dim_duration);
+        output->render->damage_whole();
 
         auto ws_views = get_workspace_views();
         for (auto v : ws_views)
@@ -494,8 +543,9 @@ class WayfireSwitcher : public wf::plugin_interface_t
         }
 
         background_dim.restart_with_end(1);
-        background_dim_duration.start();
-        duration.start();
+        start_animation(background_dim_duration);
+        start_animation(duration);
+        output->render->damage_whole();
         active = false;
 
         /* Potentially restore view[0] if it was maximized */
@@ -517,35 +567,68 @@ class WayfireSwitcher : public wf::plugin_interface_t
             output->workspace->get_current_workspace(), wf::ABOVE_LAYERS);
     }
 
-    void dim_background(float dim)
+    /* Re-render the background views to the background cache if they have
+     * changed since the last frame. */
+    void update_background_cache(const wf::framebuffer_t& fb)
     {
-        for (auto view : get_background_views())
+        auto background_views = get_background_views();
+        if (background_views != cached_background_views)
         {
-            if (dim == 1.0)
-            {
-                view->pop_transformer(switcher_transformer_background);
-            } else
-            {
-                if (!view->get_transformer(switcher_transformer_background))
-                {
-                    view->add_transformer(std::make_unique<wf::view_3D>(view),
-                        switcher_transformer_background);
-                }
+            cached_background_views = background_views;
+            background_dirty = true;
+        }
 
-                auto tr = dynamic_cast<wf::view_3D*>(
-                    view->get_transformer(switcher_transformer_background).get());
-                tr->color[0] = tr->color[1] = tr->color[2] = dim;
-            }
+        OpenGL::render_begin();
+        background_dirty |= background_cache.allocate(
+            fb.geometry.width * fb.scale, fb.geometry.height * fb.scale);
+        if (!background_dirty)
+        {
+            OpenGL::render_end();
+            return;
+        }
+
+        background_cache.geometry = fb.geometry;
+        background_cache.scale    = fb.scale;
+        background_cache.bind();
+        OpenGL::clear({0, 0, 0, 1});
+        OpenGL::render_end();
+
+        for (auto view : background_views)
+        {
+            view->render_transformed(background_cache, background_cache.geometry);
+        }
+
+        background_dirty = false;
+    }
+
+    /* Track damage of the views we render, in case they are updated while the
+     * switcher is idle. The list of views changes only when we repaint, so it
+     * is enough to update the connections on each frame. */
+    void update_damage_tracking()
+    {
+        on_view_damaged.disconnect();
+        on_background_damaged.disconnect();
+
+        for (auto view : cached_background_views)
+        {
+            view->connect_signal("region-damaged", &on_background_damaged);
+        }
+
+        std::set<wayfire_view> switcher_views;
+        for (auto& sv : views)
+        {
+            switcher_views.insert(sv.view);
+        }
+
+        for (auto view : switcher_views)
+        {
+            view->connect_signal("region-damaged", &on_view_damaged);
         }
     }
 
     SwitcherView create_switcher_view(wayfire_view view)
     {
-        /* we add a view transform if there isn't any.
-         *
-         * Note that a view might be visible on more than 1 place, so damage
-         * tracking doesn't work reliably. To circumvent this, we simply damage
-         * the whole output */
+        /* we add a view transform if there isn't any. */
         if (!view->get_transformer(switcher_transformer))
         {
             view->add_transformer(std::make_unique<wf::view_3D>(view),
@@ -559,7 +642,8 @@ class WayfireSwitcher : public wf::plugin_interface_t
         return sw;
     }
 
-    void render_view(const SwitcherView& sv, const wf::framebuffer_t& buffer)
+    void render_view(const SwitcherView& sv, const wf::framebuffer_t& buffer,
+        const wf::region_t& damage)
     {
         auto transform = dynamic_cast<wf::view_3D*>(
             sv.view->get_transformer(switcher_transformer).get());
@@ -576,30 +660,39 @@ class WayfireSwitcher : public wf::plugin_interface_t
             (float)sv.attribs.rotation, {0.0, 1.0, 0.0});
 
         transform->color[3] = sv.attribs.alpha;
-        sv.view->render_transformed(buffer, buffer.geometry);
+        sv.view->render_transformed(buffer, damage);
     }
 
     wf::render_hook_t switcher_renderer = [=] (const wf::framebuffer_t& fb)
     {
-        OpenGL::render_begin(fb);
-        OpenGL::clear({0, 0, 0, 1});
-        OpenGL::render_end();
+        update_background_cache(fb);
+        update_damage_tracking();
 
-        dim_background(background_dim);
-        for (auto view : get_background_views())
+        /* The scheduled damage also contains the damage from the previous
+         * frames which the current buffer has not seen yet. */
+        auto damage = output->render->get_scheduled_damage() & fb.geometry;
+
+        const float dim = background_dim;
+        OpenGL::render_begin(fb);
+        for (auto& box : damage)
         {
-            view->render_transformed(fb, fb.geometry);
+            fb.logic_scissor(wlr_box_from_pixman_box(box));
+            OpenGL::clear({0, 0, 0, 1});
+            OpenGL::render_texture({background_cache.tex}, fb, fb.geometry,
+                glm::vec4{dim, dim, dim, 1.0f});
         }
 
+        OpenGL::render_end();
+
         /* Render in the reverse order because we don't use depth testing */
         for (auto& view : wf::reverse(views))
         {
-            render_view(view, fb);
+            render_view(view, fb, damage);
         }
 
         for (auto view : get_overlay_views())
         {
-            view->render_transformed(fb, fb.geometry);
+            view->render_transformed(fb, damage);
         }
 
         if (!duration.running())
@@ -718,7 +811,8 @@ class WayfireSwitcher : public wf::plugin_interface_t
 
         rebuild_view_list();
         output->workspace->bring_to_front(views.front().view);
-        duration.start();
+        start_animation(duration);
+        output->render->damage_whole();
     }
 
     int count_different_active_views()
@@ -799,6 +893,8 @@ class WayfireSwitcher : public wf::plugin_interface_t
             deinit_switcher();
         }
 
+        output->render->rem_animation(&duration);
+        output->render->rem_animation(&background_dim_duration);
         output->rem_binding(&next_view_binding);
         output->rem_binding(&prev_view_binding);
         output->disconnect_signal("view-detached", &view_removed);
@@ -2,6 +2,7 @@
 #include <wayfire/output.hpp>
 #include <wayfire/opengl.hpp>
 #include <wayfire/render-manager.hpp>
+#include <wayfire/core.hpp>
 #include <wayfire/util/duration.hpp>
 
 class wayfire_zoom_screen : public wf::plugin_interface_t
@@ -32,12 +33,16 @@ class wayfire_zoom_screen : public wf::plugin_interface_t
         if (target != progression.end)
         {
             progression.animate(target);
+            output->render->add_animation(&progression);
 
             if (!hook_set)
             {
                 hook_set = true;
                 output->render->add_post(&render_hook);
-                output->render->set_redraw_always();
+                wf::get_core().connect_signal("pointer_motion_post", &on_motion);
+                wf::get_core().connect_signal("pointer_motion_absolute_post",
+                    &on_motion);
+                wf::get_core().connect_signal("tablet_axis_post", &on_motion);
             }
         }
     }
@@ -59,16 +64,40 @@ class wayfire_zoom_screen : public wf::plugin_interface_t
         return true;
     };
 
-    wf::post_hook_t render_hook = [=] (const wf::framebuffer_base_t& source,
-                                       const wf::framebuffer_base_t& destination)
+    /* The point of the output closest to the cursor, around which we zoom */
+    wf::pointf_t get_zoom_center()
     {
-        auto w = destination.viewport_width;
-        auto h = destination.viewport_height;
         auto oc = output->get_cursor_position();
         double x, y;
         wlr_box b = output->get_relative_geometry();
         wlr_box_closest_point(&b, oc.x, oc.y, &x, &y);
 
+        return {x, y};
+    }
+
+    /* The zoom center of the last painted frame */
+    wf::pointf_t last_center = {0, 0};
+
+    /* The zoomed area follows the cursor, so it has to be repainted when the
+     * cursor moves, even if the zoom level does not change. Motion on other
+     * outputs only matters if it moves the closest point on this output. */
+    wf::signal_connection_t on_motion = [=] (wf::signal_data_t*)
+    {
+        auto center = get_zoom_center();
+        if ((center.x != last_center.x) || (center.y != last_center.y))
+        {
+            output->render->schedule_redraw();
+        }
+    };
+
+    wf::post_hook_t render_hook = [=] (const wf::framebuffer_base_t& source,
+                                       const wf::framebuffer_base_t& destination)
+    {
+        auto w = destination.viewport_width;
+        auto h = destination.viewport_height;
+        last_center = get_zoom_center();
+        double x = last_center.x, y = last_center.y;
+
         /* get rotation & scale */
         wlr_box box = {int(x), int(y), 1, 1};
         box = output->render->get_target_framebuffer().
@@ -102,8 +131,9 @@ class wayfire_zoom_screen : public wf::plugin_interface_t
 
     void unset_hook()
     {
-        output->render->set_redraw_always(false);
+        output->render->rem_animation(&progression);
         output->render->rem_post(&render_hook);
+        on_motion.disconnect();
         hook_set = false;
     }
 
@@ -111,7 +141,9 @@ class wayfire_zoom_screen : public wf::plugin_interface_t
     {
         if (hook_set)
         {
+            output->render->rem_animation(&progression);
             output->render->rem_post(&render_hook);
+            on_motion.disconnect();
         }
 
         output->rem_binding(&axis);
@@ -4,6 +4,8 @@
 #include <wayfire/plugins/common/geometry-animation.hpp>
 #include <wayfire/plugins/common/workspace-wall.hpp>
 #include <wayfire/util/duration.hpp>
+#include <wayfire/output.hpp>
+#include <wayfire/render-manager.hpp>
 #include <wayfire/view.hpp>
 #include <wayfire/view-transform.hpp>
 #include <wayfire/nonstd/reverse.hpp>
@@ -65,6 +67,7 @@ class workspace_switch_t
         animation.dx.set(0, 0);
         animation.dy.set(0, 0);
         animation.start();
+        output->render->add_animation(&animation);
     }
 
     /**
@@ -80,6 +83,7 @@ class workspace_switch_t
         animation.dx.set(animation.dx + cws.x - workspace.x, 0);
         animation.dy.set(animation.dy + cws.y - workspace.y, 0);
         animation.start();
+        output->render->add_animation(&animation);
 
         std::vector<wayfire_view> fixed_views;
         if (overlay_view)
@@ -149,6 +153,7 @@ class workspace_switch_t
         }
 
         wall->stop_output_renderer(true);
+        output->render->rem_animation(&animation);
         running = false;
     }
 
@@ -158,7 +163,9 @@ class workspace_switch_t
     }
 
     virtual ~workspace_switch_t()
-    {}
+    {
+        output->render->rem_animation(&animation);
+    }
 
   protected:
     option_wrapper_t<int> gap{"vswitch/gap"};
@@ -224,8 +231,9 @@ class workspace_switch_t
         wall->set_viewport(viewport);
 
         render_overlay_view(fb);
-        output->render->schedule_redraw();
 
+        /* The frame clock repaints while the animation is running, and once
+         * more afterwards, so that the switch is stopped here. */
         if (!animation.running())
         {
             stop_switch(true);
@@ -584,6 +584,8 @@ class wf_wobbly : public wf::view_transformer_t
         sig->output->render->rem_effect(&pre_hook);
         view->get_output()->render->add_effect(&pre_hook,
             wf::OUTPUT_EFFECT_PRE);
+        /* Each output has its own frame clock */
+        last_frame = view->get_output()->render->get_frame_time();
 
         on_workspace_changed.disconnect();
         view->get_output()->connect_signal("workspace-changed",
@@ -620,7 +622,7 @@ class wf_wobbly : public wf::view_transformer_t
     {
         this->view = view;
         init_model();
-        last_frame = wf::get_current_time();
+        last_frame = view->get_output()->render->get_frame_time();
 
         pre_hook = [=] () { update_model(); };
         view->get_output()->render->add_effect(&pre_hook, wf::OUTPUT_EFFECT_PRE);
@@ -679,8 +681,9 @@ class wf_wobbly : public wf::view_transformer_t
         state->handle_frame();
         view->connect_signal("geometry-changed", &this->view_geometry_changed);
 
-        /* Update all the wobbly model */
-        auto now = wf::get_current_time();
+        /* Update all the wobbly model, with the same time as other animations
+         * painted in this frame */
+        auto now = view->get_output()->render->get_frame_time();
         wobbly_prepare_paint(model.get(), now - last_frame);
 
         /* Update wobbly geometry */
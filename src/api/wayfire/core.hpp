@@ -317,6 +317,17 @@ class compositor_core_t : public wf::object_base_t
      */
     virtual compositor_state_t get_current_state() = 0;
 
+    /**
+     * Check whether views are being mapped in a batch, i.e. more than one view
+     * has been mapped in the current event loop iteration (for ex. during
+     * session restore).
+     *
+     * While a batch is active, listeners of view-mapped may defer expensive
+     * work and do it once for all views when the map-batch-done signal is
+     * emitted on core at the end of the event loop iteration.
+     */
+    virtual bool is_map_batch_active() = 0;
+
     /**
      * Shut down the whole compositor.
      *
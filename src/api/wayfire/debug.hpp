@@ -7,6 +7,10 @@
 
 #define nonull(x) ((x) ? (x) : ("nil"))
 #include <wayfire/util/log.hpp>
+#include <chrono>
+#include <string>
+#include <sys/types.h>
+#include <vector>
 
 namespace wf
 {
@@ -18,6 +22,57 @@ namespace wf
  *   information will be printed (for ex., line numbers may be missing).
  */
 void print_trace(bool fast_mode);
+
+/**
+ * CPU time spent in the callbacks of one kind registered by one plugin,
+ * excluding the callbacks nested in them. Collected only when wayfire is
+ * started with --profile-hooks.
+ */
+struct hook_profile_t
+{
+    /** The shared object which registered the hooks, or "core". */
+    std::string owner;
+    /** effect, post, render or "signal <name>" */
+    std::string kind;
+    uint64_t calls;
+    std::chrono::nanoseconds total;
+    std::chrono::nanoseconds max;
+};
+
+/**
+ * @return The hook statistics collected so far, most expensive first.
+ *   Empty if profiling is disabled.
+ */
+std::vector<hook_profile_t> get_hook_profile();
+
+/** Statistics about a series of durations. */
+struct latency_stat_t
+{
+    uint64_t count = 0;
+    std::chrono::nanoseconds total{0};
+    std::chrono::nanoseconds max{0};
+
+    std::chrono::nanoseconds average() const
+    {
+        return count ? total / count : std::chrono::nanoseconds{0};
+    }
+};
+
+/**
+ * Buffer latency of a single client.
+ * Collected only when wayfire is started with --buffer-latency.
+ */
+struct buffer_latency_t
+{
+    pid_t pid;
+    /** From the commit of a buffer until the compositor first renders it. */
+    latency_stat_t sample;
+    /** From the commit of a buffer until it is released to the client. */
+    latency_stat_t release;
+};
+
+/** @return The buffer latency of all connected clients. */
+std::vector<buffer_latency_t> get_buffer_latency();
 }
 
 /* ------------------- Miscallaneous helpers for debugging ------------------ */
@@ -108,6 +108,11 @@ class custom_data_t
 /**
  * A base class for "objects". Objects provide signals and ways for plugins to
  * store custom data about the object.
+ *
+ * Custom data is stored in slots. Each name under which data is stored gets a
+ * small integer index, which is the same for all objects. The typed variants
+ * of the custom data functions use typeid(T).name() as a name and compute the
+ * slot index only once per type, so they do not need any string operations.
  */
 class object_base_t : public signal_provider_t
 {
@@ -118,6 +123,21 @@ class object_base_t : public signal_provider_t
     /** Get the ID of the object. Each object has a unique ID */
     uint32_t get_id() const;
 
+    /**
+     * Get the slot index of custom data stored with the given name.
+     * The index is allocated on first use and stays the same until Wayfire
+     * exits.
+     */
+    static uint32_t get_data_slot(const std::string& name);
+
+    /** Get the slot index of custom data stored for the type T. */
+    template<class T>
+    static uint32_t get_data_slot()
+    {
+        static const uint32_t slot = get_data_slot(typeid(T).name());
+        return slot;
+    }
+
     /**
      * Retrieve custom data stored with the given name. If no such data exists,
      * then it is created with the default constructor.
@@ -126,43 +146,52 @@ class object_base_t : public signal_provider_t
      * If your type doesn't have one, use store_data + get_data
      */
     template<class T>
-    nonstd::observer_ptr<T> get_data_safe(
-        std::string name = typeid(T).name())
+    nonstd::observer_ptr<T> get_data_safe(std::string name)
     {
-        auto data = get_data<T>(name);
-        if (data)
-        {
-            return data;
-        } else
-        {
-            store_data<T>(std::make_unique<T>(), name);
+        return get_data_safe<T>(get_data_slot(name));
+    }
 
-            return get_data<T>(name);
-        }
+    /** Same as get_data_safe(name), with the name typeid(T).name() */
+    template<class T>
+    nonstd::observer_ptr<T> get_data_safe()
+    {
+        return get_data_safe<T>(get_data_slot<T>());
     }
 
     /* Retrieve custom data stored with the given name. If no such
      * data exists, NULL is returned */
     template<class T>
-    nonstd::observer_ptr<T> get_data(
-        std::string name = typeid(T).name())
+    nonstd::observer_ptr<T> get_data(std::string name)
+    {
+        return get_data<T>(find_data_slot(name));
+    }
+
+    /** Same as get_data(name), with the name typeid(T).name() */
+    template<class T>
+    nonstd::observer_ptr<T> get_data()
     {
-        return nonstd::make_observer(dynamic_cast<T*>(_fetch_data(name)));
+        return get_data<T>(get_data_slot<T>());
     }
 
     /* Assigns the given data to the given name */
     template<class T>
-    void store_data(std::unique_ptr<T> stored_data,
-        std::string name = typeid(T).name())
+    void store_data(std::unique_ptr<T> stored_data, std::string name)
     {
-        _store_data(std::move(stored_data), name);
+        _store_data(std::move(stored_data), get_data_slot(name));
+    }
+
+    /** Same as store_data(data, name), with the name typeid(T).name() */
+    template<class T>
+    void store_data(std::unique_ptr<T> stored_data)
+    {
+        _store_data(std::move(stored_data), get_data_slot<T>());
     }
 
     /* Returns true if there is saved data under the given name */
     template<class T>
     bool has_data()
     {
-        return has_data(typeid(T).name());
+        return _fetch_data(get_data_slot<T>()) != nullptr;
     }
 
     /** @return true if there is saved data with the given name */
@@ -175,22 +204,21 @@ class object_base_t : public signal_provider_t
     template<class T>
     void erase_data()
     {
-        erase_data(typeid(T).name());
+        _erase_data(get_data_slot<T>());
     }
 
     /* Erase the saved data from the store and return the pointer */
     template<class T>
-    std::unique_ptr<T> release_data(
-        std::string name = typeid(T).name())
+    std::unique_ptr<T> release_data(std::string name)
     {
-        if (!has_data(name))
-        {
-            return {nullptr};
-        }
-
-        auto stored = _fetch_erase(name);
+        return release_data<T>(find_data_slot(name));
+    }
 
-        return std::unique_ptr<T>(dynamic_cast<T*>(stored));
+    /** Same as release_data(name), with the name typeid(T).name() */
+    template<class T>
+    std::unique_ptr<T> release_data()
+    {
+        return release_data<T>(get_data_slot<T>());
     }
 
     virtual ~object_base_t();
@@ -202,14 +230,51 @@ class object_base_t : public signal_provider_t
     void _clear_data();
 
   private:
-    /** Just get the data under the given name, or nullptr, if it does not exist */
-    custom_data_t *_fetch_data(std::string name);
-    /** Get the data under the given name, and release the pointer, deleting
-     * the entry in the map */
-    custom_data_t *_fetch_erase(std::string name);
-
-    /** Store the given data under the given name */
-    void _store_data(std::unique_ptr<custom_data_t> data, std::string name);
+    /**
+     * Get the slot index of custom data stored with the given name, without
+     * allocating a new slot. If no slot has been allocated for the name, an
+     * index which is never backed by data is returned.
+     */
+    static uint32_t find_data_slot(const std::string& name);
+
+    template<class T>
+    nonstd::observer_ptr<T> get_data_safe(uint32_t slot)
+    {
+        auto data = get_data<T>(slot);
+        if (data)
+        {
+            return data;
+        } else
+        {
+            _store_data(std::make_unique<T>(), slot);
+
+            return get_data<T>(slot);
+        }
+    }
+
+    template<class T>
+    nonstd::observer_ptr<T> get_data(uint32_t slot)
+    {
+        return nonstd::make_observer(dynamic_cast<T*>(_fetch_data(slot)));
+    }
+
+    template<class T>
+    std::unique_ptr<T> release_data(uint32_t slot)
+    {
+        return std::unique_ptr<T>(dynamic_cast<T*>(_fetch_erase(slot)));
+    }
+
+    /** Just get the data in the given slot, or nullptr, if it does not exist */
+    custom_data_t *_fetch_data(uint32_t slot);
+    /** Get the data in the given slot, and release the pointer, emptying the
+     * slot */
+    custom_data_t *_fetch_erase(uint32_t slot);
+
+    /** Store the given data in the given slot */
+    void _store_data(std::unique_ptr<custom_data_t> data, uint32_t slot);
+
+    /** Destroy the data in the given slot */
+    void _erase_data(uint32_t slot);
 
     class obase_impl;
     std::unique_ptr<obase_impl> obase_priv;
@@ -14,6 +14,14 @@
 #include <glm/mat4x4.hpp>
 #include <glm/vec4.hpp>
 
+// WF_USE_CONFIG_H is set only when building Wayfire itself, external plugins
+// need to use <wayfire/config.h>
+#ifdef WF_USE_CONFIG_H
+    #include <config.h>
+#else
+    #include <wayfire/config.h>
+#endif
+
 void gl_call(const char*, uint32_t, const char*);
 
 #ifndef __STRING
@@ -23,8 +31,17 @@ void gl_call(const char*, uint32_t, const char*);
 /*
  * recommended to use this to make OpenGL calls, since it offers easier debugging
  * This macro is taken from WLC source code
+ *
+ * When Wayfire is built with -Dgl_error_checking=false, the error check is
+ * compiled out entirely, so that release builds do not issue a glGetError()
+ * after every call. GL errors can still be diagnosed at runtime via
+ * the KHR_debug extension, see the --gl-debug command line option.
  */
-#define GL_CALL(x) x;gl_call(__PRETTY_FUNCTION__, __LINE__, __STRING(x))
+#ifdef WF_DISABLE_GL_ERROR_CHECKS
+    #define GL_CALL(x) x
+#else
+    #define GL_CALL(x) x;gl_call(__PRETTY_FUNCTION__, __LINE__, __STRING(x))
+#endif
 
 struct gl_geometry
 {
@@ -6,6 +6,11 @@
 
 namespace wf
 {
+namespace animation
+{
+class duration_t;
+}
+
 struct framebuffer_base_t;
 struct framebuffer_t;
 struct region_t;
@@ -56,6 +61,54 @@ enum output_effect_type_t
 using post_hook_t = std::function<void (const wf::framebuffer_base_t& source,
     const wf::framebuffer_base_t& destination)>;
 
+/** The outcome of an attempt to directly scan out a view. */
+enum scanout_result_t
+{
+    /* The view was scanned out */
+    SCANOUT_SUCCESS          = 0,
+    /* A plugin renderer, effect or post effect, or output inhibition */
+    SCANOUT_REJECT_PLUGIN    = 1,
+    /* Software cursors or a drag-and-drop icon need compositing */
+    SCANOUT_REJECT_CURSOR    = 2,
+    /* No view is visible on the output */
+    SCANOUT_REJECT_NO_VIEW   = 3,
+    /* The topmost visible view does not cover the whole output */
+    SCANOUT_REJECT_GEOMETRY  = 4,
+    /* Another view or a subsurface is visible above the view */
+    SCANOUT_REJECT_OCCLUDED  = 5,
+    /* The view has a transformer */
+    SCANOUT_REJECT_TRANSFORM = 6,
+    /* The surface scale, transform or buffer doesn't match the output */
+    SCANOUT_REJECT_SURFACE   = 7,
+    /* The view is not fully opaque */
+    SCANOUT_REJECT_OPAQUE    = 8,
+    /* The backend refused the buffer, e.g because of its format */
+    SCANOUT_REJECT_COMMIT    = 9,
+    SCANOUT_RESULT_COUNT     = 10,
+};
+
+/** Counters of direct scanout attempts, by result. */
+struct scanout_stats_t
+{
+    uint64_t count[SCANOUT_RESULT_COUNT] = {0};
+    /** The result of the last attempt */
+    scanout_result_t last = SCANOUT_SUCCESS;
+};
+
+/** @return A short description of the scanout result, for logging. */
+const char *scanout_result_to_string(scanout_result_t result);
+
+/**
+ * Counters of damaged workspace stream updates. Streams with their own buffer
+ * are not repainted if no view on their workspace changed since the last
+ * update.
+ */
+struct stream_stats_t
+{
+    uint64_t rendered = 0;
+    uint64_t skipped  = 0;
+};
+
 /** Render manager
  *
  * Each output has a render manager, which is responsible for all rendering
@@ -94,6 +147,53 @@ class render_manager : public wf::signal_provider_t
      */
     void schedule_redraw();
 
+    /**
+     * Get the time of the frame which is currently being painted, or of the
+     * last painted frame if called outside of the repaint cycle.
+     *
+     * The frame time is sampled once per frame and approximates the time when
+     * the frame will be presented. Animations should use it instead of
+     * sampling the wall clock, so that all animations on the output advance
+     * consistently. With the --virtual-clock command line option, the frame
+     * time advances by exactly one refresh cycle per frame.
+     *
+     * @return The frame time in milliseconds, in the same clock as
+     *   wf::get_current_time().
+     */
+    uint32_t get_frame_time() const;
+
+    /**
+     * Get the sequence number of the frame which is currently being painted, or
+     * of the last painted frame if called outside of the repaint cycle.
+     *
+     * Unlike the frame time, the sequence number is different for each frame,
+     * so it can be used to reuse results computed earlier in the same frame.
+     * The first frame has the sequence number 1.
+     */
+    uint64_t get_frame_sequence() const;
+
+    /**
+     * Register an animation which is driven by the repaint cycle of the
+     * output. While the animation is running, a new frame is scheduled after
+     * each repaint. After the animation has finished, one more frame is
+     * scheduled, so that its final state is drawn, and then the animation is
+     * automatically unregistered.
+     *
+     * Note that the animation still has to damage what it changes.
+     *
+     * @param animation The animation to track. It must stay alive until it
+     *   finishes or is removed with rem_animation().
+     * @param view The view which is being animated, if any. Animations of
+     *   views which are not visible on the output do not schedule frames.
+     */
+    void add_animation(wf::animation::duration_t *animation,
+        wayfire_view view = nullptr);
+
+    /**
+     * Unregister an animation. No-op if the animation isn't registered.
+     */
+    void rem_animation(wf::animation::duration_t *animation);
+
     /**
      * Inhibit rendering to the output. An inhibited output will show a
      * fully black image. Used mainly for compositor fade in/out on startup.
@@ -181,6 +281,16 @@ class render_manager : public wf::signal_provider_t
      */
     wf::framebuffer_t get_target_framebuffer() const;
 
+    /**
+     * Get statistics about direct scanout on this output. Each repainted
+     * frame counts as one attempt, so the counters show how often and why
+     * frames had to be composited.
+     */
+    const scanout_stats_t& get_scanout_stats() const;
+
+    /** Get statistics about workspace stream updates on this output. */
+    const stream_stats_t& get_stream_stats() const;
+
     /**
      * Initialize a workspace stream. If you need to change the stream's
      * attributes, you should stop the stream, and start it again
@@ -195,8 +305,10 @@ class render_manager : public wf::signal_provider_t
      * render or an overlay hook.
      *
      * @param stream The workspace stream to update
-     * @param scale_x Unused for now
-     * @param scale_y Unused for now
+     * @param scale_x The fraction of the output width at which the stream is
+     *   displayed. The stream is always rendered at full size, but the rate at
+     *   which views on the workspace get frame callbacks depends on it.
+     * @param scale_y Like scale_x, for the output height.
      */
     void workspace_stream_update(workspace_stream_t& stream,
         float scale_x = 1, float scale_y = 1);
@@ -376,6 +376,19 @@ struct view_mapped_signal : public _view_signal
     bool is_positioned = false;
 };
 
+/**
+ * name: map-batch-done
+ * on: core
+ * when: At the end of an event loop iteration in which more than one view was
+ *   mapped, even if some of them were destroyed since then. See
+ *   compositor_core_t::is_map_batch_active().
+ */
+struct map_batch_done_signal : public wf::signal_data_t
+{
+    /** The views mapped in the batch which are still alive, in map order. */
+    std::vector<wayfire_view> views;
+};
+
 /**
  * name: pre-unmapped
  * on: view, output(view-)
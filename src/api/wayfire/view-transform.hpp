@@ -107,6 +107,18 @@ class view_transformer_t
         wlr_box scissor_box, const wf::framebuffer_t& target_fb)
     {}
 
+    /**
+     * Get a hash of the parameters which affect how the transformer renders.
+     *
+     * Core uses it to reuse the offscreen result of the transformer when the
+     * view is rendered several times in the same frame. Transformers which
+     * return 0, the default, are always rendered again.
+     */
+    virtual uint64_t get_state_hash()
+    {
+        return 0;
+    }
+
     virtual ~view_transformer_t()
     {}
 };
@@ -139,6 +151,7 @@ class view_2D : public view_transformer_t
         wf::geometry_t view, wf::pointf_t point) override;
     void render_box(wf::texture_t src_tex, wlr_box src_box,
         wlr_box scissor_box, const wf::framebuffer_t& target_fb) override;
+    uint64_t get_state_hash() override;
 };
 
 /* Those are centered relative to the view's bounding box */
@@ -168,6 +181,7 @@ class view_3D : public view_transformer_t
         wf::geometry_t view, wf::pointf_t point) override;
     void render_box(wf::texture_t src_tex, wlr_box src_box,
         wlr_box scissor_box, const wf::framebuffer_t& target_fb) override;
+    uint64_t get_state_hash() override;
 
     static const float fov; // PI / 8
     static glm::mat4 default_view_matrix();
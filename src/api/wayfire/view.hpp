@@ -439,6 +439,21 @@ class view_interface_t : public surface_interface_t
      */
     virtual void take_snapshot();
 
+    /**
+     * Reduce the resolution of the snapshot of an unmapped view.
+     *
+     * Animations which shrink a view after it has been unmapped can use this to
+     * avoid sampling a full-size snapshot for the rest of the animation. Since
+     * the view is unmapped, the snapshot cannot be taken again, so this
+     * operation loses detail permanently.
+     *
+     * Does nothing if the view is mapped or has no snapshot.
+     *
+     * @param factor The fraction of the current snapshot size to keep, in
+     *   (0, 1).
+     */
+    void downscale_snapshot(float factor);
+
     /**
      * View lifetime is managed by reference counting. To take a reference,
      * use take_ref(). Note that one reference is automatically made when the
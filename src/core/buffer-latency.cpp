@@ -0,0 +1,170 @@
+#include "buffer-latency.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+
+#include <wayfire/debug.hpp>
+#include <wayfire/nonstd/wlroots-full.hpp>
+
+bool wf::buffer_latency::enabled = false;
+
+namespace
+{
+struct client_stats_t
+{
+    pid_t pid = 0;
+    wf::latency_stat_t sample;
+    wf::latency_stat_t release;
+    wl_listener on_destroy;
+};
+
+std::unordered_map<wl_client*, std::unique_ptr<client_stats_t>> clients;
+
+int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void handle_client_destroy(wl_listener *listener, void *data)
+{
+    auto client = static_cast<wl_client*>(data);
+    auto it     = clients.find(client);
+    if (it != clients.end())
+    {
+        auto& stats = *it->second;
+        LOGD("Buffer latency of pid ", stats.pid, ": ",
+            stats.sample.count, " samples, average ",
+            stats.sample.average().count() / 1e6, "ms; ",
+            stats.release.count, " releases, average ",
+            stats.release.average().count() / 1e6, "ms");
+        wl_list_remove(&stats.on_destroy.link);
+        clients.erase(it);
+    }
+}
+
+client_stats_t& get_client_stats(wl_client *client)
+{
+    auto& stats = clients[client];
+    if (!stats)
+    {
+        stats = std::make_unique<client_stats_t>();
+        wl_client_get_credentials(client, &stats->pid, NULL, NULL);
+        stats->on_destroy.notify = handle_client_destroy;
+        wl_client_add_destroy_listener(client, &stats->on_destroy);
+    }
+
+    return *stats;
+}
+
+void add_sample(wf::latency_stat_t& stat, int64_t since)
+{
+    auto value = std::chrono::nanoseconds(now_ns() - since);
+    stat.count++;
+    stat.total += value;
+    stat.max    = std::max(stat.max, value);
+}
+
+/**
+ * Waits until a committed buffer is released. Deletes itself afterwards, or
+ * when the buffer is destroyed.
+ */
+struct release_tracker_t
+{
+    wl_client *client;
+    int64_t commit_time;
+    wl_listener on_release;
+    wl_listener on_destroy;
+
+    release_tracker_t(wl_client *client, wlr_buffer *buffer, int64_t commit_time)
+    {
+        this->client = client;
+        this->commit_time = commit_time;
+
+        on_release.notify = [] (wl_listener *listener, void*)
+        {
+            release_tracker_t *self =
+                wl_container_of(listener, self, on_release);
+            /* The client may be gone, then the buffer is not really released */
+            auto it = clients.find(self->client);
+            if (it != clients.end())
+            {
+                add_sample(it->second->release, self->commit_time);
+            }
+
+            delete self;
+        };
+        on_destroy.notify = [] (wl_listener *listener, void*)
+        {
+            release_tracker_t *self =
+                wl_container_of(listener, self, on_destroy);
+            delete self;
+        };
+
+        wl_signal_add(&buffer->events.release, &on_release);
+        wl_signal_add(&buffer->events.destroy, &on_destroy);
+    }
+
+    ~release_tracker_t()
+    {
+        wl_list_remove(&on_release.link);
+        wl_list_remove(&on_destroy.link);
+    }
+};
+}
+
+void wf::buffer_latency::enable()
+{
+    enabled = true;
+}
+
+void wf::buffer_latency::surface_tracker_t::handle_commit(wlr_surface *surface)
+{
+    if (!(surface->current.committed & WLR_SURFACE_STATE_BUFFER))
+    {
+        return;
+    }
+
+    if (!surface->buffer)
+    {
+        /* A null buffer was attached, nothing to render */
+        commit_time = 0;
+        return;
+    }
+
+    commit_time = now_ns();
+    auto client = wl_resource_get_client(surface->resource);
+    auto& stats = get_client_stats(client);
+
+    /* wlroots has already imported the buffer. Shared memory buffers are
+     * copied and released right away, while DMA-BUFs stay locked by their
+     * texture until the surface gets a new buffer. */
+    auto source = surface->buffer->source;
+    if (source && (source->n_locks > 0))
+    {
+        new release_tracker_t(client, source, commit_time);
+    } else
+    {
+        add_sample(stats.release, commit_time);
+    }
+}
+
+void wf::buffer_latency::surface_tracker_t::handle_sample(wlr_surface *surface)
+{
+    auto client = wl_resource_get_client(surface->resource);
+    add_sample(get_client_stats(client).sample, commit_time);
+    commit_time = 0;
+}
+
+std::vector<wf::buffer_latency_t> wf::get_buffer_latency()
+{
+    std::vector<buffer_latency_t> result;
+    for (auto& [client, stats] : clients)
+    {
+        result.push_back({stats->pid, stats->sample, stats->release});
+    }
+
+    return result;
+}
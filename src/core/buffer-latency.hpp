@@ -0,0 +1,55 @@
+#ifndef WF_BUFFER_LATENCY_HPP
+#define WF_BUFFER_LATENCY_HPP
+
+#include <cstdint>
+#include <wayfire/nonstd/wlroots.hpp>
+
+namespace wf
+{
+/**
+ * Per-client statistics about the lifetime of committed buffers: how long it
+ * takes until the compositor first renders a new buffer, and until it is
+ * released back to the client.
+ *
+ * Enabled with the --buffer-latency command line option, see
+ * wf::get_buffer_latency() for the results.
+ */
+namespace buffer_latency
+{
+extern bool enabled;
+
+void enable();
+
+/** Tracks the buffer of a single surface. */
+class surface_tracker_t
+{
+  public:
+    /** A new state of the surface was committed. */
+    void committed(wlr_surface *surface)
+    {
+        if (enabled)
+        {
+            handle_commit(surface);
+        }
+    }
+
+    /** The current buffer of the surface was rendered. */
+    void sampled(wlr_surface *surface)
+    {
+        if (enabled && commit_time)
+        {
+            handle_sample(surface);
+        }
+    }
+
+  private:
+    /* Commit time of a buffer which has not been rendered yet, or 0 */
+    int64_t commit_time = 0;
+
+    void handle_commit(wlr_surface *surface);
+    void handle_sample(wlr_surface *surface);
+};
+}
+}
+
+#endif /* end of include guard: WF_BUFFER_LATENCY_HPP */
@@ -10,6 +10,7 @@
 
 struct wayfire_shell;
 struct wf_gtk_shell;
+struct wf_thumbnail_manager;
 
 namespace wf
 {
@@ -47,6 +48,7 @@ class compositor_core_impl_t : public compositor_core_t
 
     wayfire_shell *wf_shell;
     wf_gtk_shell *gtk_shell;
+    wf_thumbnail_manager *thumbnail_manager;
 
     /**
      * Remove a view from the compositor list. This is called when the view's
@@ -96,6 +98,20 @@ class compositor_core_impl_t : public compositor_core_t
     pid_t run(std::string command) override;
     void shutdown() override;
     compositor_state_t get_current_state() override;
+    bool is_map_batch_active() override;
+
+    /**
+     * Register a view which was just mapped, to track map batches.
+     * Called before the view-mapped signal is emitted.
+     */
+    void note_view_mapped(wayfire_view view);
+
+    /**
+     * Incremented each time an output starts painting a frame. Unlike the
+     * frame sequence of a single output, it identifies the frame which is
+     * being painted, whichever output paints it.
+     */
+    uint64_t paint_sequence = 0;
 
   private:
     wf::wl_listener_wrapper decoration_created;
@@ -128,6 +144,17 @@ class compositor_core_impl_t : public compositor_core_t
 
     compositor_state_t state = compositor_state_t::UNKNOWN;
 
+    /** Views mapped in the current event loop iteration */
+    std::vector<wayfire_view> mapped_in_iteration;
+    /**
+     * Whether more than one view was mapped in the current event loop
+     * iteration. Stays set when views of the batch are destroyed, so that
+     * map-batch-done is emitted for every started batch.
+     */
+    bool map_batch_active = false;
+    wf::wl_idle_call idle_finish_map_batch;
+    void finish_map_batch();
+
     compositor_core_impl_t();
     virtual ~compositor_core_impl_t();
 };
@@ -27,6 +27,7 @@
 #include "../output/wayfire-shell.hpp"
 #include "../output/output-impl.hpp"
 #include "../output/gtk-shell.hpp"
+#include "../output/wayfire-thumbnail.hpp"
 
 #include "core-impl.hpp"
 
@@ -304,6 +305,7 @@ void wf::compositor_core_impl_t::init()
 
     wf_shell  = wayfire_shell_create(display);
     gtk_shell = wf_gtk_shell_create(display);
+    thumbnail_manager = wf_thumbnail_manager_create(display);
 
     image_io::init();
     OpenGL::init();
@@ -370,6 +372,35 @@ wf::compositor_state_t wf::compositor_core_impl_t::get_current_state()
     return this->state;
 }
 
+bool wf::compositor_core_impl_t::is_map_batch_active()
+{
+    return map_batch_active;
+}
+
+void wf::compositor_core_impl_t::note_view_mapped(wayfire_view view)
+{
+    mapped_in_iteration.push_back(view);
+    if (mapped_in_iteration.size() > 1)
+    {
+        map_batch_active = true;
+    }
+
+    idle_finish_map_batch.run_once([=] () { finish_map_batch(); });
+}
+
+void wf::compositor_core_impl_t::finish_map_batch()
+{
+    wf::map_batch_done_signal data;
+    std::swap(data.views, mapped_in_iteration);
+    if (map_batch_active)
+    {
+        /* Listeners flush their deferred work, which must not be deferred
+         * again */
+        map_batch_active = false;
+        emit_signal("map-batch-done", &data);
+    }
+}
+
 wlr_seat*wf::compositor_core_impl_t::get_current_seat()
 {
     return seat->seat;
@@ -753,6 +784,10 @@ void wf::compositor_core_impl_t::erase_view(wayfire_view v)
     auto it = std::find_if(views.begin(), views.end(),
         [&v] (const auto& view) { return view.get() == v.get(); });
 
+    auto batch_it = std::remove(mapped_in_iteration.begin(),
+        mapped_in_iteration.end(), v);
+    mapped_in_iteration.erase(batch_it, mapped_in_iteration.end());
+
     v->deinitialize();
     views.erase(it);
 }
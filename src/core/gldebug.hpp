@@ -1,34 +1,39 @@
-#include <GLES3/gl32.h>
+#include <GLES3/gl3.h>
+#include <GLES2/gl2ext.h>
+#include <EGL/egl.h>
+#include <cstring>
 #include <wayfire/debug.hpp>
 
-const char *getStrSrc(GLenum src)
+/* The KHR_debug extension defines the same values as core GLES 3.2 */
+
+static const char *getStrSrc(GLenum src)
 {
-    if (src == GL_DEBUG_SOURCE_API)
+    if (src == GL_DEBUG_SOURCE_API_KHR)
     {
         return "API";
     }
 
-    if (src == GL_DEBUG_SOURCE_WINDOW_SYSTEM)
+    if (src == GL_DEBUG_SOURCE_WINDOW_SYSTEM_KHR)
     {
         return "WINDOW_SYSTEM";
     }
 
-    if (src == GL_DEBUG_SOURCE_SHADER_COMPILER)
+    if (src == GL_DEBUG_SOURCE_SHADER_COMPILER_KHR)
     {
         return "SHADER_COMPILER";
     }
 
-    if (src == GL_DEBUG_SOURCE_THIRD_PARTY)
+    if (src == GL_DEBUG_SOURCE_THIRD_PARTY_KHR)
     {
         return "THIRD_PARTYB";
     }
 
-    if (src == GL_DEBUG_SOURCE_APPLICATION)
+    if (src == GL_DEBUG_SOURCE_APPLICATION_KHR)
     {
         return "APPLICATIONB";
     }
 
-    if (src == GL_DEBUG_SOURCE_OTHER)
+    if (src == GL_DEBUG_SOURCE_OTHER_KHR)
     {
         return "OTHER";
     } else
@@ -37,34 +42,34 @@ const char *getStrSrc(GLenum src)
     }
 }
 
-const char *getStrType(GLenum type)
+static const char *getStrType(GLenum type)
 {
-    if (type == GL_DEBUG_TYPE_ERROR)
+    if (type == GL_DEBUG_TYPE_ERROR_KHR)
     {
         return "ERROR";
     }
 
-    if (type == GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR)
+    if (type == GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR_KHR)
     {
         return "DEPRECATED_BEHAVIOR";
     }
 
-    if (type == GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR)
+    if (type == GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR_KHR)
     {
         return "UNDEFINED_BEHAVIOR";
     }
 
-    if (type == GL_DEBUG_TYPE_PORTABILITY)
+    if (type == GL_DEBUG_TYPE_PORTABILITY_KHR)
     {
         return "PORTABILITY";
     }
 
-    if (type == GL_DEBUG_TYPE_PERFORMANCE)
+    if (type == GL_DEBUG_TYPE_PERFORMANCE_KHR)
     {
         return "PERFORMANCE";
     }
 
-    if (type == GL_DEBUG_TYPE_OTHER)
+    if (type == GL_DEBUG_TYPE_OTHER_KHR)
     {
         return "OTHER";
     }
@@ -72,24 +77,24 @@ const char *getStrType(GLenum type)
     return "UNKNOWN";
 }
 
-const char *getStrSeverity(GLenum severity)
+static const char *getStrSeverity(GLenum severity)
 {
-    if (severity == GL_DEBUG_SEVERITY_HIGH)
+    if (severity == GL_DEBUG_SEVERITY_HIGH_KHR)
     {
         return "HIGH";
     }
 
-    if (severity == GL_DEBUG_SEVERITY_MEDIUM)
+    if (severity == GL_DEBUG_SEVERITY_MEDIUM_KHR)
     {
         return "MEDIUM";
     }
 
-    if (severity == GL_DEBUG_SEVERITY_LOW)
+    if (severity == GL_DEBUG_SEVERITY_LOW_KHR)
     {
         return "LOW";
     }
 
-    if (severity == GL_DEBUG_SEVERITY_NOTIFICATION)
+    if (severity == GL_DEBUG_SEVERITY_NOTIFICATION_KHR)
     {
         return "NOTIFICATION";
     }
@@ -97,27 +102,84 @@ const char *getStrSeverity(GLenum severity)
     return "UNKNOWN";
 }
 
-void errorHandler(GLenum src, GLenum type, GLuint id, GLenum severity,
-    GLsizei len, const GLchar *msg, const void *dummy)
+static void GL_APIENTRY errorHandler(GLenum src, GLenum type, GLuint id,
+    GLenum severity, GLsizei len, const GLchar *msg, const void *dummy)
 {
     // ignore notifications
-    if (severity == GL_DEBUG_SEVERITY_NOTIFICATION)
+    if (severity == GL_DEBUG_SEVERITY_NOTIFICATION_KHR)
     {
         return;
     }
 
-    LOGI(
-        "_______________________________________________\n",
-        "Source: ", getStrSrc(src), "\n",
-        "Type: ", getStrType(type), "\n",
-        "Severity: ", getStrSeverity(severity), "\n",
-        "Msg: ", msg, "\n",
-        "_______________________________________________\n");
+    if (type == GL_DEBUG_TYPE_ERROR_KHR)
+    {
+        LOGE("GL error from ", getStrSrc(src), " (severity ",
+            getStrSeverity(severity), "): ", msg);
+    } else
+    {
+        LOGI("GL debug message from ", getStrSrc(src), ", type ",
+            getStrType(type), " (severity ", getStrSeverity(severity), "): ", msg);
+    }
+}
+
+/**
+ * Check whether the space-separated extension list contains the given name,
+ * not only as a prefix of a longer one.
+ */
+static bool has_extension(const char *extensions, const char *name)
+{
+    size_t len = strlen(name);
+    const char *pos = extensions;
+    while ((pos = strstr(pos, name)))
+    {
+        bool starts = (pos == extensions) || (pos[-1] == ' ');
+        bool ends   = (pos[len] == ' ') || (pos[len] == '\0');
+        if (starts && ends)
+        {
+            return true;
+        }
+
+        pos += len;
+    }
+
+    return false;
 }
 
-void enable_gl_synchronuous_debug()
+/**
+ * Enable GL debug output through the KHR_debug extension.
+ * Requires a current GL context.
+ *
+ * @param synchronous Whether the messages should be reported synchronously,
+ *   i.e. inside the GL call which caused them. This is helpful for debugging,
+ *   but can be significantly slower. Asynchronous messages may be reported
+ *   from a driver thread.
+ *
+ * @return true if the extension is supported and debug output was enabled.
+ */
+static bool enable_gl_debug_output(bool synchronous)
 {
-    glEnable(GL_DEBUG_OUTPUT);
-    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
-    glDebugMessageCallback(errorHandler, 0);
+    auto extensions = (const char*)glGetString(GL_EXTENSIONS);
+    if (!extensions || !has_extension(extensions, "GL_KHR_debug"))
+    {
+        return false;
+    }
+
+    auto debug_message_callback = (PFNGLDEBUGMESSAGECALLBACKKHRPROC)
+        eglGetProcAddress("glDebugMessageCallbackKHR");
+    if (!debug_message_callback)
+    {
+        return false;
+    }
+
+    glEnable(GL_DEBUG_OUTPUT_KHR);
+    if (synchronous)
+    {
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS_KHR);
+    } else
+    {
+        glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS_KHR);
+    }
+
+    debug_message_callback(errorHandler, 0);
+    return true;
 }
@@ -0,0 +1,223 @@
+#include "hook-profiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <dlfcn.h>
+#include <map>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+
+#include <wayfire/debug.hpp>
+
+bool wf::hook_profiler::enabled = false;
+bool wf::hook_profiler::track_running = false;
+wf::hook_profiler::scope_t*wf::hook_profiler::scope_t::running = nullptr;
+
+namespace
+{
+struct stats_t
+{
+    uint64_t calls = 0;
+    std::chrono::nanoseconds total{0};
+    std::chrono::nanoseconds max{0};
+};
+
+struct profiler_state_t
+{
+    std::chrono::nanoseconds budget{0};
+
+    /* Names of shared objects. Never freed, so that running scopes and the
+     * watchdog thread can keep pointers to them. */
+    std::set<std::string> names;
+
+    /* Hook address -> name of the owning shared object */
+    std::unordered_map<const void*, const char*> owners;
+
+    /* (owner, kind) -> stats */
+    std::map<std::tuple<std::string, std::string>, stats_t> stats;
+
+    /* (hook, owner, kind) -> time spent in the current frame */
+    std::map<std::tuple<const void*, std::string, std::string>,
+        std::chrono::nanoseconds> frame_time;
+};
+
+profiler_state_t& get_state()
+{
+    static profiler_state_t state;
+    return state;
+}
+
+std::string resolve_owner(const void *caller)
+{
+    static void *main_base = [] ()
+    {
+        Dl_info info;
+        if (dladdr((void*)&resolve_owner, &info))
+        {
+            return info.dli_fbase;
+        }
+
+        return (void*)nullptr;
+    }();
+
+    Dl_info info;
+    if (!caller || !dladdr(caller, &info) || !info.dli_fname)
+    {
+        return "unknown";
+    }
+
+    if (info.dli_fbase == main_base)
+    {
+        return "core";
+    }
+
+    std::string name = info.dli_fname;
+    auto slash = name.find_last_of('/');
+    if (slash != std::string::npos)
+    {
+        name = name.substr(slash + 1);
+    }
+
+    return name;
+}
+
+}
+
+const char*wf::hook_profiler::scope_t::find_owner(const void *hook)
+{
+    auto& owners = get_state().owners;
+    auto it = owners.find(hook);
+    return (it == owners.end()) ? "unknown" : it->second;
+}
+
+void wf::hook_profiler::enable(double budget_ms)
+{
+    enabled = true;
+    get_state().budget = std::chrono::nanoseconds((int64_t)(budget_ms * 1e6));
+}
+
+void wf::hook_profiler::enable_tracking()
+{
+    track_running = true;
+}
+
+void wf::hook_profiler::set_owner(const void *hook, const void *caller)
+{
+    if (!enabled && !track_running)
+    {
+        return;
+    }
+
+    /* Hooks are often stored by value, so the address of a removed hook may
+     * be reused by another one. Always overwrite the previous owner. */
+    auto& state = get_state();
+    state.owners[hook] = state.names.insert(resolve_owner(caller)).first->c_str();
+}
+
+void wf::hook_profiler::remove_owner(const void *hook)
+{
+    if (enabled || track_running)
+    {
+        get_state().owners.erase(hook);
+    }
+}
+
+void wf::hook_profiler::end_frame()
+{
+    if (!enabled)
+    {
+        return;
+    }
+
+    auto& state = get_state();
+    if (state.budget.count() > 0)
+    {
+        for (auto& [key, elapsed] : state.frame_time)
+        {
+            if (elapsed > state.budget)
+            {
+                LOGW("Hook ", std::get<2>(key), " of ", std::get<1>(key),
+                    " took ", elapsed.count() / 1e6, "ms in one frame (budget ",
+                    state.budget.count() / 1e6, "ms)");
+            }
+        }
+    }
+
+    state.frame_time.clear();
+}
+
+void wf::hook_profiler::scope_t::finish()
+{
+    timespec end;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end);
+    auto total = std::chrono::nanoseconds(
+        (end.tv_sec - start.tv_sec) * 1'000'000'000ll +
+        (end.tv_nsec - start.tv_nsec));
+    if (parent)
+    {
+        parent->nested += total;
+    }
+
+    auto elapsed = std::max(total - nested, std::chrono::nanoseconds{0});
+
+    auto& state = get_state();
+    std::string kind_str = kind;
+    if (detail)
+    {
+        kind_str += " " + *detail;
+    }
+
+    auto& entry = state.stats[{owner, kind_str}];
+    entry.calls++;
+    entry.total += elapsed;
+    entry.max    = std::max(entry.max, elapsed);
+
+    if (state.budget.count() > 0)
+    {
+        state.frame_time[{hook, owner, kind_str}] += elapsed;
+    }
+}
+
+size_t wf::hook_profiler::capture_running(running_hook_t *hooks, size_t max)
+{
+    size_t count = 0;
+    for (auto scope = scope_t::running; scope && (count < max);
+         scope = scope->parent)
+    {
+        auto& hook = hooks[count++];
+        hook.kind  = scope->kind;
+        hook.owner = scope->owner;
+        hook.detail[0] = '\0';
+        if (scope->detail)
+        {
+            std::strncpy(hook.detail, scope->detail->c_str(),
+                sizeof(hook.detail) - 1);
+            hook.detail[sizeof(hook.detail) - 1] = '\0';
+        }
+    }
+
+    return count;
+}
+
+std::vector<wf::hook_profile_t> wf::get_hook_profile()
+{
+    std::vector<hook_profile_t> result;
+    for (auto& [key, entry] : get_state().stats)
+    {
+        hook_profile_t profile;
+        std::tie(profile.owner, profile.kind) = key;
+        profile.calls = entry.calls;
+        profile.total = entry.total;
+        profile.max   = entry.max;
+        result.push_back(profile);
+    }
+
+    std::sort(result.begin(), result.end(),
+        [] (const hook_profile_t& a, const hook_profile_t& b)
+    {
+        return a.total > b.total;
+    });
+
+    return result;
+}
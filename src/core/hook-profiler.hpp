@@ -0,0 +1,142 @@
+#ifndef WF_HOOK_PROFILER_HPP
+#define WF_HOOK_PROFILER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <ctime>
+
+namespace wf
+{
+/**
+ * Measures the CPU time spent in callbacks registered by plugins: effect
+ * hooks, post hooks, render hooks and signal handlers.
+ *
+ * Each callback is attributed to the shared object which registered it, found
+ * with dladdr() from the return address of the registering function. Enabled
+ * with the --profile-hooks command line option, otherwise all operations are
+ * no-ops.
+ *
+ * The time of a callback excludes the time of the callbacks nested in it, for
+ * example signal handlers of signals emitted from an effect hook.
+ *
+ * The watchdog uses the same instrumentation to find out which hook is running
+ * when the main loop stalls.
+ */
+namespace hook_profiler
+{
+extern bool enabled;
+extern bool track_running;
+
+/**
+ * Start profiling.
+ *
+ * @param budget_ms The time in milliseconds each callback may take per frame,
+ *   see end_frame(). 0 disables the warnings.
+ */
+void enable(double budget_ms);
+
+/** Remember the stack of running hooks, see capture_running(). */
+void enable_tracking();
+
+/** A running hook, as copied by capture_running(). */
+struct running_hook_t
+{
+    /* Both point to strings which are never freed */
+    const char *kind;
+    const char *owner;
+    char detail[64];
+};
+
+/**
+ * Copy the hooks currently running on the main thread, innermost first.
+ * Async-signal-safe, so it can be called from a signal handler which
+ * interrupted the main thread anywhere.
+ *
+ * @return The number of hooks copied, at most @max.
+ */
+size_t capture_running(running_hook_t *hooks, size_t max);
+
+/**
+ * Remember who registered a callback.
+ *
+ * @param hook The address of the callback object.
+ * @param caller A return address in the code which registered the callback,
+ *   usually __builtin_return_address(0).
+ */
+void set_owner(const void *hook, const void *caller);
+
+/** Forget the owner of a callback, when it is no longer registered. */
+void remove_owner(const void *hook);
+
+/**
+ * Called when an output has painted a frame. Warns about the callbacks which
+ * took longer than the budget since the previous call, and starts a new frame.
+ * With several outputs, a frame is the time between two painted frames of any
+ * output.
+ */
+void end_frame();
+
+/** Measures a single invocation of a callback, from construction to destruction. */
+class scope_t
+{
+  public:
+    /**
+     * @param hook The address of the callback object.
+     * @param kind The kind of callback, e.g "effect" or "signal".
+     * @param detail Optional detail, for signals their name.
+     */
+    scope_t(const void *hook, const char *kind, const std::string *detail = nullptr)
+    {
+        if (enabled || track_running)
+        {
+            this->hook   = hook;
+            this->kind   = kind;
+            this->detail = detail;
+            this->owner  = find_owner(hook);
+            this->parent = running;
+            running = this;
+            if (enabled)
+            {
+                clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+            }
+        }
+    }
+
+    ~scope_t()
+    {
+        if (hook)
+        {
+            running = parent;
+            if (enabled)
+            {
+                finish();
+            }
+        }
+    }
+
+    scope_t(const scope_t&) = delete;
+    scope_t& operator =(const scope_t&) = delete;
+
+  private:
+    const void *hook = nullptr;
+    const char *kind = nullptr;
+    const char *owner = nullptr;
+    const std::string *detail = nullptr;
+    scope_t *parent = nullptr;
+    timespec start;
+
+    /* Time spent in nested scopes, excluded from this one */
+    std::chrono::nanoseconds nested{0};
+
+    /* The innermost running hook */
+    static scope_t *running;
+
+    static const char *find_owner(const void *hook);
+    void finish();
+    friend size_t capture_running(running_hook_t *hooks, size_t max);
+};
+}
+}
+
+#endif /* end of include guard: WF_HOOK_PROFILER_HPP */
@@ -1,6 +1,9 @@
 #include "wayfire/object.hpp"
 #include "wayfire/nonstd/safe-list.hpp"
+#include "hook-profiler.hpp"
+#include <cstdint>
 #include <unordered_map>
+#include <vector>
 #include <set>
 
 /* Implementation note: because of circular dependencies between
@@ -79,6 +82,10 @@ wf::signal_provider_t::~signal_provider_t()
         s.second.for_each([=] (signal_connection_t *connection)
         {
             connection->priv->remove(this);
+            if (connection->priv->connected_providers.empty())
+            {
+                hook_profiler::remove_owner(connection);
+            }
         });
     }
 }
@@ -86,6 +93,7 @@ wf::signal_provider_t::~signal_provider_t()
 void wf::signal_provider_t::connect_signal(std::string name,
     signal_connection_t *callback)
 {
+    hook_profiler::set_owner(callback, __builtin_return_address(0));
     sprovider_priv->signals[name].push_back(callback);
     callback->priv->add(this);
 }
@@ -106,12 +114,19 @@ void wf::signal_provider_t::disconnect_signal(signal_connection_t *connection)
             return false;
         });
     }
+
+    /* The same connection may still be connected to other providers */
+    if (connection->priv->connected_providers.empty())
+    {
+        hook_profiler::remove_owner(connection);
+    }
 }
 
 /* Deprecated: */
 void wf::signal_provider_t::connect_signal(std::string name,
     signal_callback_t *callback)
 {
+    hook_profiler::set_owner(callback, __builtin_return_address(0));
     sprovider_priv->deprecated_signals[name].push_back(callback);
 }
 
@@ -119,20 +134,23 @@ void wf::signal_provider_t::connect_signal(std::string name,
 void wf::signal_provider_t::disconnect_signal(std::string name,
     signal_callback_t *callback)
 {
+    hook_profiler::remove_owner(callback);
     sprovider_priv->deprecated_signals[name].remove_all(callback);
 }
 
 /* Emit the given signal. No type checking for data is required */
 void wf::signal_provider_t::emit_signal(std::string name, wf::signal_data_t *data)
 {
-    sprovider_priv->signals[name].for_each([data] (auto call)
+    sprovider_priv->signals[name].for_each([&] (auto call)
     {
+        hook_profiler::scope_t profile{call, "signal", &name};
         call->emit(data);
     });
 
     /* Deprecated: */
-    sprovider_priv->deprecated_signals[name].for_each([data] (auto call)
+    sprovider_priv->deprecated_signals[name].for_each([&] (auto call)
     {
+        hook_profiler::scope_t profile{call, "signal", &name};
         (*call)(data);
     });
 }
@@ -140,10 +158,48 @@ void wf::signal_provider_t::emit_signal(std::string name, wf::signal_data_t *dat
 class wf::object_base_t::obase_impl
 {
   public:
-    std::unordered_map<std::string, std::unique_ptr<custom_data_t>> data;
+    /**
+     * Custom data, indexed by slot. The array is dense: it is as long as the
+     * largest slot stored on this object, and unused slots hold nullptr.
+     */
+    std::vector<std::unique_ptr<custom_data_t>> data;
     uint32_t object_id;
 };
 
+static std::unordered_map<std::string, uint32_t>& data_slots()
+{
+    static std::unordered_map<std::string, uint32_t> slots;
+    return slots;
+}
+
+uint32_t wf::object_base_t::find_data_slot(const std::string& name)
+{
+    auto& slots = data_slots();
+    auto it     = slots.find(name);
+    if (it != slots.end())
+    {
+        return it->second;
+    }
+
+    /* Out of range for every object, so lookups in it find nothing */
+    return UINT32_MAX;
+}
+
+uint32_t wf::object_base_t::get_data_slot(const std::string& name)
+{
+    auto& slots = data_slots();
+    auto it     = slots.find(name);
+    if (it != slots.end())
+    {
+        return it->second;
+    }
+
+    uint32_t slot = slots.size();
+    slots[name] = slot;
+
+    return slot;
+}
+
 wf::object_base_t::object_base_t()
 {
     this->obase_priv = std::make_unique<obase_impl>();
@@ -167,42 +223,62 @@ uint32_t wf::object_base_t::get_id() const
 
 bool wf::object_base_t::has_data(std::string name)
 {
-    return obase_priv->data[name] != nullptr;
+    return _fetch_data(find_data_slot(name)) != nullptr;
 }
 
 void wf::object_base_t::erase_data(std::string name)
 {
-    auto data = std::move(obase_priv->data[name]);
-    obase_priv->data.erase(name);
+    _erase_data(find_data_slot(name));
+}
+
+void wf::object_base_t::_erase_data(uint32_t slot)
+{
+    if (slot >= obase_priv->data.size())
+    {
+        return;
+    }
+
+    /* The destructor of the data might access the object's data again */
+    auto data = std::move(obase_priv->data[slot]);
     data.reset();
 }
 
-wf::custom_data_t*wf::object_base_t::_fetch_data(std::string name)
+wf::custom_data_t*wf::object_base_t::_fetch_data(uint32_t slot)
 {
-    auto it = obase_priv->data.find(name);
-    if (it == obase_priv->data.end())
+    if (slot >= obase_priv->data.size())
     {
         return nullptr;
     }
 
-    return it->second.get();
+    return obase_priv->data[slot].get();
 }
 
-wf::custom_data_t*wf::object_base_t::_fetch_erase(std::string name)
+wf::custom_data_t*wf::object_base_t::_fetch_erase(uint32_t slot)
 {
-    auto data = obase_priv->data[name].release();
-    erase_data(name);
+    if (slot >= obase_priv->data.size())
+    {
+        return nullptr;
+    }
 
-    return data;
+    return obase_priv->data[slot].release();
 }
 
 void wf::object_base_t::_store_data(std::unique_ptr<wf::custom_data_t> data,
-    std::string name)
+    uint32_t slot)
 {
-    obase_priv->data[name] = std::move(data);
+    if (slot >= obase_priv->data.size())
+    {
+        obase_priv->data.resize(slot + 1);
+    }
+
+    /* Destroy the old data only after the new data has been stored */
+    auto old_data = std::move(obase_priv->data[slot]);
+    obase_priv->data[slot] = std::move(data);
 }
 
 void wf::object_base_t::_clear_data()
 {
+    auto data = std::move(obase_priv->data);
     obase_priv->data.clear();
+    data.clear();
 }
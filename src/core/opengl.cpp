@@ -4,6 +4,8 @@
 #include "wayfire/output.hpp"
 #include "core-impl.hpp"
 #include "config.h"
+#include "gldebug.hpp"
+#include "../main.hpp"
 #include <wayfire/nonstd/wlroots-full.hpp>
 
 #include <glm/gtc/matrix_transform.hpp>
@@ -30,17 +32,21 @@ const char *gl_error_string(const GLenum err)
     return "UNKNOWN GL ERROR";
 }
 
+/* Set when errors are reported through KHR_debug instead */
+static bool gl_debug_active = false;
+/* Set temporarily around our own draw calls */
 static bool disable_gl_call = false;
 void gl_call(const char *func, uint32_t line, const char *glfunc)
 {
     GLenum err;
-    if (disable_gl_call || ((err = glGetError()) == GL_NO_ERROR))
+    if (gl_debug_active || disable_gl_call ||
+        ((err = glGetError()) == GL_NO_ERROR))
     {
         return;
     }
 
     LOGE("gles2: function ", glfunc, " in ", func, " line ", line, ": ",
-        gl_error_string(glGetError()));
+        gl_error_string(err));
 }
 
 namespace OpenGL
@@ -95,7 +101,20 @@ GLuint compile_program(std::string vertex_source, std::string frag_source)
 void init()
 {
     render_begin();
-    // enable_gl_synchronuous_debug()
+    if (runtime_config.gl_debug)
+    {
+        /* The logger is not thread-safe, so the messages must arrive on the
+         * thread which makes the GL calls */
+        if (enable_gl_debug_output(true))
+        {
+            LOGI("Reporting GL errors via KHR_debug");
+            gl_debug_active = true;
+        } else
+        {
+            LOGW("GL_KHR_debug is not supported, falling back to glGetError()");
+        }
+    }
+
     program.compile(default_vertex_shader_source,
         default_fragment_shader_source);
 
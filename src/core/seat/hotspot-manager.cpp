@@ -1,23 +1,287 @@
 #include "hotspot-manager.hpp"
+#include <wayfire/core.hpp>
+#include <algorithm>
 
-void wf::hotspot_instance_t::process_input_motion(wf::point_t gc)
+wf::hotspot_index_t& wf::hotspot_index_t::get(wf::output_t *output)
 {
-    if (!(hotspot_geometry[0] & gc) && !(hotspot_geometry[1] & gc))
+    if (!output->has_data<hotspot_index_t>())
+    {
+        output->store_data(std::make_unique<hotspot_index_t>(output));
+    }
+
+    return *output->get_data<hotspot_index_t>();
+}
+
+wf::hotspot_index_t::hotspot_index_t(wf::output_t *output)
+{
+    this->output = output;
+
+    on_motion_event.set_callback([=] (wf::signal_data_t*)
+    {
+        idle_check_input.run_once([=] ()
+        {
+            auto gcf = wf::get_core().get_cursor_position();
+            process_input_motion({(int)gcf.x, (int)gcf.y});
+        });
+    });
+
+    on_touch_motion_event.set_callback([=] (wf::signal_data_t*)
+    {
+        idle_check_input.run_once([=] ()
+        {
+            auto gcf = wf::get_core().get_touch_position(0);
+            process_input_motion({(int)gcf.x, (int)gcf.y});
+        });
+    });
+
+    on_output_config_changed.set_callback([=] (wf::signal_data_t*)
+    {
+        rebuild();
+    });
+
+    output->connect_signal("configuration-changed", &on_output_config_changed);
+}
+
+void wf::hotspot_index_t::add_hotspot(hotspot_t *hotspot)
+{
+    if (std::find(all.begin(), all.end(), hotspot) != all.end())
+    {
+        return;
+    }
+
+    hotspot->state = hotspot_t::IDLE;
+    all.push_back(hotspot);
+    if (all.size() == 1)
+    {
+        wf::get_core().connect_signal("pointer_motion", &on_motion_event);
+        wf::get_core().connect_signal("tablet_axis", &on_motion_event);
+        wf::get_core().connect_signal("touch_motion", &on_touch_motion_event);
+    }
+
+    rebuild();
+}
+
+void wf::hotspot_index_t::rem_hotspot(hotspot_t *hotspot)
+{
+    auto it = std::find(all.begin(), all.end(), hotspot);
+    if (it == all.end())
+    {
+        return;
+    }
+
+    all.erase(it);
+    active.erase(std::remove(active.begin(), active.end(), hotspot), active.end());
+    hotspot->state = hotspot_t::IDLE;
+
+    if (all.empty())
+    {
+        on_motion_event.disconnect();
+        on_touch_motion_event.disconnect();
+        idle_check_input.disconnect();
+        idle_rearm_timer.disconnect();
+        timer.disconnect();
+    }
+
+    rebuild();
+}
+
+void wf::hotspot_index_t::update_hotspot(hotspot_t *hotspot)
+{
+    rebuild();
+}
+
+void wf::hotspot_index_t::rebuild()
+{
+    for (int i = 0; i < NUM_BUCKETS; i++)
+    {
+        buckets[i].clear();
+        band[i] = 0;
+    }
+
+    interior.clear();
+
+    auto og = output->get_layout_geometry();
+    auto add_to = [] (std::vector<hotspot_t*>& list, hotspot_t *hotspot)
+    {
+        if (std::find(list.begin(), list.end(), hotspot) == list.end())
+        {
+            list.push_back(hotspot);
+        }
+    };
+
+    for (auto& hotspot : all)
+    {
+        for (auto& area : hotspot->areas)
+        {
+            if ((area.width <= 0) || (area.height <= 0))
+            {
+                continue;
+            }
+
+            // Extent of the area away from each edge it touches, or -1
+            const int extent[NUM_BUCKETS] = {
+                area.y <= og.y ? area.y + area.height - og.y : -1,
+                area.y + area.height >= og.y + og.height ?
+                og.y + og.height - area.y : -1,
+                area.x <= og.x ? area.x + area.width - og.x : -1,
+                area.x + area.width >= og.x + og.width ?
+                og.x + og.width - area.x : -1,
+            };
+
+            // Put the area in the band of the edge it extends least away from,
+            // so that strips along an edge do not widen the perpendicular bands
+            int best = -1;
+            for (int i = 0; i < NUM_BUCKETS; i++)
+            {
+                if ((extent[i] >= 0) && ((best < 0) || (extent[i] < extent[best])))
+                {
+                    best = i;
+                }
+            }
+
+            if (best < 0)
+            {
+                add_to(interior, hotspot);
+            } else
+            {
+                add_to(buckets[best], hotspot);
+                band[best] = std::max(band[best], extent[best]);
+            }
+        }
+    }
+}
+
+void wf::hotspot_index_t::process_input_motion(wf::point_t gc)
+{
+    std::vector<hotspot_t*> inside;
+    auto check = [&] (hotspot_t *hotspot)
+    {
+        if (std::find(inside.begin(), inside.end(), hotspot) != inside.end())
+        {
+            return;
+        }
+
+        for (auto& area : hotspot->areas)
+        {
+            if (area & gc)
+            {
+                inside.push_back(hotspot);
+                return;
+            }
+        }
+    };
+
+    auto og = output->get_layout_geometry();
+    if (og & gc)
+    {
+        const bool in_band[NUM_BUCKETS] = {
+            gc.y < og.y + band[0],
+            gc.y >= og.y + og.height - band[1],
+            gc.x < og.x + band[2],
+            gc.x >= og.x + og.width - band[3],
+        };
+
+        for (int i = 0; i < NUM_BUCKETS; i++)
+        {
+            if (in_band[i])
+            {
+                std::for_each(buckets[i].begin(), buckets[i].end(), check);
+            }
+        }
+
+        std::for_each(interior.begin(), interior.end(), check);
+    }
+
+    auto previously_active = active;
+    for (auto& hotspot : previously_active)
+    {
+        if (std::find(inside.begin(), inside.end(), hotspot) == inside.end())
+        {
+            leave(hotspot);
+        }
+    }
+
+    const uint32_t now = get_current_time();
+    for (auto& hotspot : inside)
+    {
+        if (hotspot->state == hotspot_t::IDLE)
+        {
+            hotspot->state    = hotspot_t::PENDING;
+            hotspot->deadline = now + hotspot->timeout_ms;
+            active.push_back(hotspot);
+        }
+    }
+
+    schedule_timer();
+}
+
+void wf::hotspot_index_t::leave(hotspot_t *hotspot)
+{
+    active.erase(std::remove(active.begin(), active.end(), hotspot), active.end());
+    auto old_state = hotspot->state;
+    hotspot->state = hotspot_t::IDLE;
+
+    if ((old_state == hotspot_t::TRIGGERED) && hotspot->on_leave)
+    {
+        hotspot->on_leave();
+    }
+}
+
+void wf::hotspot_index_t::schedule_timer()
+{
+    const uint32_t now = get_current_time();
+    bool has_pending   = false;
+    int32_t next_timeout = 0;
+    for (auto& hotspot : active)
+    {
+        if (hotspot->state == hotspot_t::PENDING)
+        {
+            int32_t remaining = std::max(0, (int32_t)(hotspot->deadline - now));
+            next_timeout = has_pending ? std::min(next_timeout, remaining) : remaining;
+            has_pending  = true;
+        }
+    }
+
+    if (!has_pending)
     {
         timer.disconnect();
-        this->armed = true;
         return;
     }
 
-    if (!timer.is_connected() && this->armed)
+    timer.set_timeout(next_timeout, [=] ()
+    {
+        handle_timeout();
+        // handle_timeout() re-arms the timer if there are more pending hotspots
+        return false;
+    });
+}
+
+void wf::hotspot_index_t::handle_timeout()
+{
+    const uint32_t now = get_current_time();
+    std::vector<hotspot_t*> due;
+    for (auto& hotspot : active)
     {
-        this->armed = false;
-        timer.set_timeout(timeout_ms, [=] ()
+        if ((hotspot->state == hotspot_t::PENDING) &&
+            ((int32_t)(now - hotspot->deadline) >= 0))
         {
-            callback(this->edges);
-            return false;
-        });
+            hotspot->state = hotspot_t::TRIGGERED;
+            due.push_back(hotspot);
+        }
     }
+
+    for (auto& hotspot : due)
+    {
+        // The callback of a previous hotspot might have removed this one
+        bool still_tracked = std::find(all.begin(), all.end(), hotspot) != all.end();
+        if (still_tracked && (hotspot->state == hotspot_t::TRIGGERED) &&
+            hotspot->on_trigger)
+        {
+            hotspot->on_trigger();
+        }
+    }
+
+    idle_rearm_timer.run_once([=] () { schedule_timer(); });
 }
 
 wf::geometry_t wf::hotspot_instance_t::pin(wf::dimensions_t dim) noexcept
@@ -60,8 +324,7 @@ void wf::hotspot_instance_t::recalc_geometry() noexcept
 
     if (cnt_edges == 2)
     {
-        hotspot_geometry[0] = pin({away, along});
-        hotspot_geometry[1] = pin({along, away});
+        hotspot.areas = {pin({away, along}), pin({along, away})};
     } else
     {
         wf::dimensions_t dim;
@@ -73,8 +336,7 @@ void wf::hotspot_instance_t::recalc_geometry() noexcept
             dim = {along, away};
         }
 
-        hotspot_geometry[0] = pin(dim);
-        hotspot_geometry[1] = hotspot_geometry[0];
+        hotspot.areas = {pin(dim)};
     }
 }
 
@@ -83,40 +345,34 @@ wf::hotspot_instance_t::hotspot_instance_t(wf::output_t *output, uint32_t edges,
     std::function<void(uint32_t)> callback)
 {
     output->connect_signal("configuration-changed", &on_output_config_changed);
-    wf::get_core().connect_signal("pointer_motion", &on_motion_event);
-    wf::get_core().connect_signal("tablet_axis", &on_motion_event);
-    wf::get_core().connect_signal("touch_motion", &on_touch_motion_event);
 
     this->edges = edges;
     this->along = along;
     this->away  = away;
-    this->timeout_ms = timeout;
-    this->output     = output;
-    this->callback   = callback;
-
-    recalc_geometry();
+    this->output = output;
 
-    // callbacks
-    on_motion_event.set_callback([=] (wf::signal_data_t *data)
+    hotspot.timeout_ms = timeout;
+    hotspot.on_trigger = [=] ()
     {
-        auto gcf = wf::get_core().get_cursor_position();
-        wf::point_t gc{(int)gcf.x, (int)gcf.y};
-        process_input_motion(gc);
-    });
+        callback(this->edges);
+    };
 
-    on_touch_motion_event.set_callback([=] (wf::signal_data_t *data)
-    {
-        auto gcf = wf::get_core().get_touch_position(0);
-        wf::point_t gc{(int)gcf.x, (int)gcf.y};
-        process_input_motion(gc);
-    });
+    recalc_geometry();
+    hotspot_index_t::get(output).add_hotspot(&hotspot);
 
+    // callbacks
     on_output_config_changed.set_callback([=] (wf::signal_data_t*)
     {
         recalc_geometry();
+        hotspot_index_t::get(this->output).update_hotspot(&hotspot);
     });
 }
 
+wf::hotspot_instance_t::~hotspot_instance_t()
+{
+    hotspot_index_t::get(output).rem_hotspot(&hotspot);
+}
+
 void wf::hotspot_manager_t::update_hotspots(const container_t& activators)
 {
     hotspots.clear();
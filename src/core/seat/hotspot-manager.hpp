@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <vector>
 #include "wayfire/util.hpp"
 #include <wayfire/config/types.hpp>
 #include <wayfire/output.hpp>
@@ -27,6 +28,100 @@ struct output_binding_t : public binding_t
 template<class Option, class Callback> using binding_container_t =
     std::vector<std::unique_ptr<output_binding_t<Option, Callback>>>;
 
+/**
+ * An index of all hotspots on an output.
+ *
+ * Instead of every hotspot listening for input motion and checking the input
+ * position separately, the index listens once per output and checks only the
+ * hotspots in the edge band which contains the input position. The width of
+ * each edge band is the maximal extent of a hotspot away from that edge, so an
+ * input position in the interior of the output does not check any hotspot.
+ *
+ * The timeouts of all hotspots on the output are driven by a single timer.
+ */
+class hotspot_index_t : public wf::custom_data_t
+{
+  public:
+    /**
+     * A hotspot tracked by the index.
+     */
+    class hotspot_t
+    {
+      public:
+        /** The hotspot areas, in output-layout coordinates. */
+        std::vector<wf::geometry_t> areas;
+
+        /** Time the input has to stay in the hotspot before it is triggered. */
+        uint32_t timeout_ms = 0;
+
+        /** Called when the hotspot is triggered. */
+        std::function<void()> on_trigger;
+
+        /** Called when the input leaves a triggered hotspot. Optional. */
+        std::function<void()> on_leave;
+
+      private:
+        friend class hotspot_index_t;
+        enum state_t
+        {
+            /* Input is outside of the hotspot */
+            IDLE,
+            /* Input is inside, waiting for the timeout */
+            PENDING,
+            /* Input is inside, hotspot has been triggered */
+            TRIGGERED,
+        };
+
+        state_t state = IDLE;
+        uint32_t deadline = 0;
+    };
+
+    /** Get the index for the given output, creating it if necessary. */
+    static hotspot_index_t& get(wf::output_t *output);
+
+    hotspot_index_t(wf::output_t *output);
+
+    /**
+     * Start tracking a hotspot. The hotspot must be removed from the index
+     * before it is destroyed.
+     */
+    void add_hotspot(hotspot_t *hotspot);
+
+    /** Stop tracking the hotspot. No-op if the hotspot is not tracked. */
+    void rem_hotspot(hotspot_t *hotspot);
+
+    /** Must be called after the areas of a tracked hotspot change. */
+    void update_hotspot(hotspot_t *hotspot);
+
+  private:
+    wf::output_t *output;
+
+    /** Edge buckets, in the order top, bottom, left, right */
+    static constexpr int NUM_BUCKETS = 4;
+    std::vector<hotspot_t*> buckets[NUM_BUCKETS];
+    int band[NUM_BUCKETS] = {0, 0, 0, 0};
+    /** Hotspots which do not touch any edge of the output */
+    std::vector<hotspot_t*> interior;
+
+    /** Hotspots which are not IDLE */
+    std::vector<hotspot_t*> active;
+    std::vector<hotspot_t*> all;
+
+    wf::wl_idle_call idle_check_input;
+    wf::wl_idle_call idle_rearm_timer;
+    wf::wl_timer timer;
+
+    wf::signal_connection_t on_motion_event;
+    wf::signal_connection_t on_touch_motion_event;
+    wf::signal_connection_t on_output_config_changed;
+
+    void rebuild();
+    void process_input_motion(wf::point_t gc);
+    void leave(hotspot_t *hotspot);
+    void schedule_timer();
+    void handle_timeout();
+};
+
 /**
  * Represents an instance of a hotspot.
  */
@@ -35,42 +130,23 @@ class hotspot_instance_t : public noncopyable_t
   public:
     hotspot_instance_t(wf::output_t *output, uint32_t edges, uint32_t along,
         uint32_t away, int32_t timeout, std::function<void(uint32_t)> callback);
+    ~hotspot_instance_t();
 
   private:
     /** The output this hotspot is on */
     wf::output_t *output;
 
-    /** The possible hotspot rectangles */
-    wf::geometry_t hotspot_geometry[2];
+    /** The hotspot as registered in the output's hotspot index */
+    hotspot_index_t::hotspot_t hotspot;
 
     /** Requested dimensions */
     int32_t along, away;
 
-    /** Timer for hotspot activation */
-    wf::wl_timer timer;
-
-    /**
-     * Only one event should be triggered once the cursor enters the hotspot area.
-     * This prevents another event being fired until the cursor has left the area.
-     */
-    bool armed = true;
-
-    /** Timeout to activate hotspot */
-    uint32_t timeout_ms;
-
     /** Edges of the hotspot */
     uint32_t edges;
 
-    /** Callback to execute */
-    std::function<void(uint32_t)> callback;
-
-    wf::signal_connection_t on_motion_event;
-    wf::signal_connection_t on_touch_motion_event;
     wf::signal_connection_t on_output_config_changed;
 
-    /** Update state based on input motion */
-    void process_input_motion(wf::point_t gc);
-
     /** Calculate a rectangle with size @dim inside @og at the correct edges. */
     wf::geometry_t pin(wf::dimensions_t dim) noexcept;
 
@@ -21,6 +21,17 @@ void wf::keyboard_t::setup_listeners()
     });
     wf::get_core().connect_signal("reload-config", &on_config_reload);
 
+    on_keymap_compiled.set_callback([&] (signal_data_t*)
+    {
+        if (waiting_for_keymap &&
+            !keymap_cache_t::get().is_compiling(pending_keymap))
+        {
+            this->dirty_options = true;
+            reload_input_options();
+        }
+    });
+    keymap_cache_t::get().connect_signal("keymap-compiled", &on_keymap_compiled);
+
     on_key.set_callback([&] (void *data)
     {
         auto ev   = static_cast<wlr_keyboard_key_event*>(data);
@@ -105,33 +116,28 @@ void wf::keyboard_t::reload_input_options()
 
     this->dirty_options = false;
 
-    auto ctx = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
-
-    /* Copy memory to stack, so that .c_str() is valid */
-    std::string rules   = this->rules;
-    std::string model   = this->model;
-    std::string layout  = this->layout;
-    std::string variant = this->variant;
-    std::string options = this->options;
-
-    xkb_rule_names names;
-    names.rules   = rules.c_str();
-    names.model   = model.c_str();
-    names.layout  = layout.c_str();
-    names.variant = variant.c_str();
-    names.options = options.c_str();
-    auto keymap = xkb_map_new_from_names(ctx, &names,
-        XKB_KEYMAP_COMPILE_NO_FLAGS);
+    keymap_names_t names{rules, model, layout, variant, options};
+    auto& cache = keymap_cache_t::get();
+    auto keymap = cache.find_keymap(names);
+
+    /* Keep the current keymap while the new one is compiled in the background.
+     * If the compilation failed, fall back to compiling synchronously, which
+     * also logs the error. */
+    bool previous_failed = waiting_for_keymap && (pending_keymap == names) &&
+        !cache.is_compiling(names);
+    if (!keymap && compile_async && handle->keymap && !previous_failed &&
+        cache.compile_async(names))
+    {
+        waiting_for_keymap = true;
+        pending_keymap     = names;
+        wlr_keyboard_set_repeat_info(handle, repeat_rate, repeat_delay);
+        return;
+    }
 
+    waiting_for_keymap = false;
     if (!keymap)
     {
-        LOGE("Could not create keymap with given configuration:",
-            " rules=\"", rules, "\" model=\"", model, "\" layout=\"", layout,
-            "\" variant=\"", variant, "\" options=\"", options, "\"");
-
-        // reset to NULL
-        std::memset(&names, 0, sizeof(names));
-        keymap = xkb_map_new_from_names(ctx, &names, XKB_KEYMAP_COMPILE_NO_FLAGS);
+        keymap = cache.get_keymap(names);
     }
 
     xkb_mod_mask_t locked_mods = 0;
@@ -148,7 +154,6 @@ void wf::keyboard_t::reload_input_options()
 
     wlr_keyboard_set_keymap(handle, keymap);
     xkb_keymap_unref(keymap);
-    xkb_context_unref(ctx);
 
     wlr_keyboard_set_repeat_info(handle, repeat_rate, repeat_delay);
 
@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include "seat.hpp"
+#include "keymap-cache.hpp"
 #include "wayfire/util.hpp"
 #include <wayfire/option-wrapper.hpp>
 
@@ -36,13 +37,18 @@ class keyboard_t
     void setup_listeners();
 
     wf::signal_connection_t on_config_reload;
+    wf::signal_connection_t on_keymap_compiled;
     void reload_input_options();
 
     wf::option_wrapper_t<std::string>
     model, variant, layout, options, rules;
     wf::option_wrapper_t<int> repeat_rate, repeat_delay;
+    wf::option_wrapper_t<bool> compile_async{"input/xkb_compile_async"};
     /** Options have changed in the config file */
     bool dirty_options = true;
+    /** The new keymap is being compiled, the old one is still in use */
+    bool waiting_for_keymap = false;
+    keymap_names_t pending_keymap;
 
     std::chrono::steady_clock::time_point mod_binding_start;
 
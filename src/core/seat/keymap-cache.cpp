@@ -0,0 +1,241 @@
+#include "keymap-cache.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include <wayfire/core.hpp>
+#include <wayfire/util/log.hpp>
+#include <wayfire/nonstd/wlroots-full.hpp>
+
+/* Keymaps of previous configurations are kept for a while, so that switching
+ * back and forth between layouts does not recompile them. */
+static constexpr size_t MAX_CACHED_KEYMAPS = 8;
+
+struct wf::keymap_cache_t::job_t
+{
+    keymap_names_t names;
+    xkb_keymap *result = nullptr;
+    /* The names were invalid and the default keymap was used instead */
+    bool used_default = false;
+    std::atomic<bool> done{false};
+};
+
+static void log_invalid_names(const wf::keymap_names_t& names)
+{
+    LOGE("Could not create keymap with given configuration:",
+        " rules=\"", names.rules, "\" model=\"", names.model,
+        "\" layout=\"", names.layout, "\" variant=\"", names.variant,
+        "\" options=\"", names.options, "\"");
+}
+
+/**
+ * Compile the keymap, or the default keymap if the names are invalid.
+ * Safe to call from worker threads, as it does not log.
+ */
+static xkb_keymap *compile_keymap(xkb_context *ctx,
+    const wf::keymap_names_t& names, bool& used_default)
+{
+    xkb_rule_names rmlvo;
+    rmlvo.rules   = names.rules.c_str();
+    rmlvo.model   = names.model.c_str();
+    rmlvo.layout  = names.layout.c_str();
+    rmlvo.variant = names.variant.c_str();
+    rmlvo.options = names.options.c_str();
+    auto keymap = xkb_map_new_from_names(ctx, &rmlvo,
+        XKB_KEYMAP_COMPILE_NO_FLAGS);
+
+    used_default = !keymap;
+    if (!keymap)
+    {
+        // reset to NULL
+        std::memset(&rmlvo, 0, sizeof(rmlvo));
+        keymap = xkb_map_new_from_names(ctx, &rmlvo, XKB_KEYMAP_COMPILE_NO_FLAGS);
+    }
+
+    return keymap;
+}
+
+wf::keymap_cache_t& wf::keymap_cache_t::get()
+{
+    /* Never destroyed: worker threads may still be running at exit */
+    static keymap_cache_t *cache = new keymap_cache_t();
+    return *cache;
+}
+
+wf::keymap_cache_t::keymap_cache_t()
+{
+    context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+}
+
+void wf::keymap_cache_t::add_entry(const keymap_names_t& names,
+    xkb_keymap *keymap)
+{
+    for (auto it = entries.begin(); it != entries.end(); ++it)
+    {
+        if (it->names == names)
+        {
+            xkb_keymap_unref(it->keymap);
+            entries.erase(it);
+            break;
+        }
+    }
+
+    entries.push_front({names, xkb_keymap_ref(keymap)});
+    while (entries.size() > MAX_CACHED_KEYMAPS)
+    {
+        xkb_keymap_unref(entries.back().keymap);
+        entries.pop_back();
+    }
+}
+
+xkb_keymap*wf::keymap_cache_t::find_keymap(const keymap_names_t& names)
+{
+    for (auto it = entries.begin(); it != entries.end(); ++it)
+    {
+        if (it->names == names)
+        {
+            entries.splice(entries.begin(), entries, it);
+            return xkb_keymap_ref(it->keymap);
+        }
+    }
+
+    return nullptr;
+}
+
+xkb_keymap*wf::keymap_cache_t::get_keymap(const keymap_names_t& names)
+{
+    if (auto keymap = find_keymap(names))
+    {
+        return keymap;
+    }
+
+    bool used_default;
+    auto keymap = compile_keymap(context, names, used_default);
+    if (used_default)
+    {
+        log_invalid_names(names);
+    }
+
+    if (keymap)
+    {
+        add_entry(names, keymap);
+    }
+
+    return keymap;
+}
+
+bool wf::keymap_cache_t::is_compiling(const keymap_names_t& names) const
+{
+    for (auto& job : jobs)
+    {
+        if (job->names == names)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool wf::keymap_cache_t::compile_async(const keymap_names_t& names)
+{
+    if (is_compiling(names))
+    {
+        return true;
+    }
+
+    if (auto keymap = find_keymap(names))
+    {
+        xkb_keymap_unref(keymap);
+        return true;
+    }
+
+    if (notify_fd < 0)
+    {
+        notify_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (notify_fd < 0)
+        {
+            LOGE("Failed to create eventfd for keymap compilation: ",
+                strerror(errno));
+            return false;
+        }
+
+        wl_event_loop_add_fd(wf::get_core().ev_loop, notify_fd,
+            WL_EVENT_READABLE, handle_job_done, this);
+    }
+
+    auto job = std::make_shared<job_t>();
+    job->names = names;
+    jobs.push_back(job);
+
+    /* xkb contexts are not thread-safe, so the worker uses its own. The
+     * keymap keeps a reference to it, which is dropped on the main thread
+     * once the keymap is no longer used. */
+    int fd = notify_fd;
+    std::thread([job, fd] ()
+    {
+        auto ctx = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+        if (ctx)
+        {
+            job->result = compile_keymap(ctx, job->names, job->used_default);
+            xkb_context_unref(ctx);
+        }
+
+        job->done = true;
+        /* Writing 1 to an eventfd fails only if the counter would overflow,
+         * in which case the main thread is woken up anyway. */
+        uint64_t one = 1;
+        (void)!write(fd, &one, sizeof(one));
+    }).detach();
+
+    return true;
+}
+
+int wf::keymap_cache_t::handle_job_done(int fd, uint32_t mask, void *data)
+{
+    uint64_t count;
+    if (read(fd, &count, sizeof(count)) < 0)
+    {
+        return 0;
+    }
+
+    static_cast<keymap_cache_t*>(data)->collect_finished_jobs();
+    return 0;
+}
+
+void wf::keymap_cache_t::collect_finished_jobs()
+{
+    bool any_done = false;
+    auto it = jobs.begin();
+    while (it != jobs.end())
+    {
+        auto& job = *it;
+        if (!job->done)
+        {
+            ++it;
+            continue;
+        }
+
+        if (job->used_default)
+        {
+            log_invalid_names(job->names);
+        }
+
+        if (job->result)
+        {
+            add_entry(job->names, job->result);
+            xkb_keymap_unref(job->result);
+        }
+
+        any_done = true;
+        it = jobs.erase(it);
+    }
+
+    if (any_done)
+    {
+        emit_signal("keymap-compiled", nullptr);
+    }
+}
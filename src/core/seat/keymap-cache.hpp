@@ -0,0 +1,99 @@
+#ifndef WF_SEAT_KEYMAP_CACHE_HPP
+#define WF_SEAT_KEYMAP_CACHE_HPP
+
+#include <list>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <xkbcommon/xkbcommon.h>
+#include <wayfire/object.hpp>
+
+namespace wf
+{
+/** The RMLVO names a keymap is compiled from. */
+struct keymap_names_t
+{
+    std::string rules, model, layout, variant, options;
+
+    bool operator ==(const keymap_names_t& other) const
+    {
+        return std::tie(rules, model, layout, variant, options) ==
+               std::tie(other.rules, other.model, other.layout, other.variant,
+            other.options);
+    }
+};
+
+/**
+ * name: keymap-compiled
+ * on: keymap cache
+ * when: A keymap compiled in the background has been added to the cache.
+ */
+
+/**
+ * A process-wide cache of compiled keymaps.
+ *
+ * Compiling a keymap takes tens of milliseconds, and setups with several
+ * keyboard devices (docking stations, KVMs, security keys) would otherwise
+ * compile the same keymap again for each device. Keymaps are shared between
+ * keyboards by reference.
+ */
+class keymap_cache_t : public wf::signal_provider_t
+{
+  public:
+    static keymap_cache_t& get();
+
+    /**
+     * Get the keymap for the given names, compiling it if necessary.
+     *
+     * If the names are invalid, an error is logged and the default keymap is
+     * returned (and cached for these names).
+     *
+     * @return A new reference to the keymap, or nullptr if even the default
+     *   keymap could not be compiled.
+     */
+    xkb_keymap *get_keymap(const keymap_names_t& names);
+
+    /**
+     * Get the keymap for the given names, only if it is already compiled.
+     *
+     * @return A new reference to the keymap, or nullptr.
+     */
+    xkb_keymap *find_keymap(const keymap_names_t& names);
+
+    /**
+     * Compile the keymap for the given names on a worker thread. When it is
+     * ready, it is added to the cache and keymap-compiled is emitted.
+     *
+     * Does nothing if the keymap is already cached or being compiled.
+     *
+     * @return false if the worker thread could not be started. The caller
+     *   should use get_keymap() instead in this case.
+     */
+    bool compile_async(const keymap_names_t& names);
+
+    /** @return Whether the keymap for the given names is being compiled. */
+    bool is_compiling(const keymap_names_t& names) const;
+
+  private:
+    keymap_cache_t();
+
+    struct job_t;
+    struct entry_t
+    {
+        keymap_names_t names;
+        xkb_keymap *keymap;
+    };
+
+    xkb_context *context;
+    /* Most recently used first */
+    std::list<entry_t> entries;
+    std::list<std::shared_ptr<job_t>> jobs;
+    int notify_fd = -1;
+
+    void add_entry(const keymap_names_t& names, xkb_keymap *keymap);
+    static int handle_job_done(int fd, uint32_t mask, void *data);
+    void collect_finished_jobs();
+};
+}
+
+#endif /* end of include guard: WF_SEAT_KEYMAP_CACHE_HPP */
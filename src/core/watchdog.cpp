@@ -0,0 +1,328 @@
+#include "watchdog.hpp"
+#include "hook-profiler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <execinfo.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <wayfire/core.hpp>
+#include <wayfire/debug.hpp>
+
+namespace
+{
+/* Buckets of the histogram: below 1ms, then [2^(i-1), 2^i) ms, and the last one
+ * collects everything longer than a second. */
+constexpr size_t NUM_BUCKETS = 12;
+std::array<uint64_t, NUM_BUCKETS> histogram;
+
+std::chrono::milliseconds threshold;
+pthread_t main_thread;
+
+/* Written by the main thread, read by the watchdog. The start is 0 while the
+ * main thread waits for events. */
+std::atomic<int64_t> iteration_start{0};
+std::atomic<uint64_t> iteration_seq{0};
+
+struct request_t
+{
+    const char *interface = nullptr;
+    const char *name = nullptr;
+    uint32_t id;
+    pid_t pid;
+};
+
+/* The last Wayland request in the current iteration. Only touched by the main
+ * thread. */
+request_t last_request;
+
+constexpr int MAX_FRAMES = 64;
+constexpr size_t MAX_HOOKS = 16;
+
+/* Filled by the stall handler on the main thread, then formatted and logged by
+ * the watchdog thread once report_seq is the sequence number of the stall. */
+struct
+{
+    void *frames[MAX_FRAMES];
+    int frame_count;
+    wf::hook_profiler::running_hook_t hooks[MAX_HOOKS];
+    size_t hook_count;
+    request_t request;
+} stall_report;
+
+/* The stall the watchdog waits a report for, or 0. The handler claims it by
+ * resetting it, so a handler which runs after the watchdog gave up does not
+ * touch stall_report. */
+std::atomic<uint64_t> requested_seq{0};
+std::atomic<uint64_t> report_seq{0};
+
+/* The logger is not thread-safe, so the watchdog thread formats its messages
+ * here and writes them directly to the log output, which is stdout. */
+char log_buffer[4096];
+size_t log_length = 0;
+
+int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void log_request(void *data, wl_protocol_logger_type type,
+    const wl_protocol_logger_message *message)
+{
+    if (type != WL_PROTOCOL_LOGGER_REQUEST)
+    {
+        return;
+    }
+
+    last_request.interface = wl_resource_get_class(message->resource);
+    last_request.name = message->message->name;
+    last_request.id   = wl_resource_get_id(message->resource);
+    last_request.pid  = 0;
+    wl_client_get_credentials(wl_resource_get_client(message->resource),
+        &last_request.pid, NULL, NULL);
+}
+
+/* Runs on the main thread, interrupted in the middle of the stalled iteration,
+ * so it only copies what it needs into preallocated storage. */
+void handle_stall(int signal)
+{
+    uint64_t seq = requested_seq.exchange(0);
+    if (seq == 0)
+    {
+        return;
+    }
+
+    /* The interrupted code may check errno right after the handler returns */
+    int saved_errno = errno;
+    stall_report.frame_count = backtrace(stall_report.frames, MAX_FRAMES);
+    stall_report.hook_count  =
+        wf::hook_profiler::capture_running(stall_report.hooks, MAX_HOOKS);
+    stall_report.request = last_request;
+    report_seq = seq;
+    errno = saved_errno;
+}
+
+void log_append(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(log_buffer + log_length,
+        sizeof(log_buffer) - log_length, format, args);
+    va_end(args);
+
+    if (length > 0)
+    {
+        log_length = std::min(log_length + length, sizeof(log_buffer) - 1);
+    }
+}
+
+void log_flush()
+{
+    size_t written = 0;
+    while (written < log_length)
+    {
+        ssize_t result =
+            write(STDOUT_FILENO, log_buffer + written, log_length - written);
+        if (result <= 0)
+        {
+            break;
+        }
+
+        written += result;
+    }
+
+    log_length = 0;
+}
+
+/* Runs on the watchdog thread */
+void log_stall(int64_t stall_ms)
+{
+    log_append("EE watchdog: Main loop stalled for %" PRId64 "ms\n", stall_ms);
+
+    log_append("EE watchdog: Running hooks: ");
+    if (stall_report.hook_count == 0)
+    {
+        log_append("none");
+    }
+
+    for (size_t i = 0; i < stall_report.hook_count; i++)
+    {
+        auto& hook = stall_report.hooks[i];
+        log_append("%s%s", (i > 0) ? " <- " : "", hook.kind);
+        if (hook.detail[0])
+        {
+            log_append(" %s", hook.detail);
+        }
+
+        log_append(" (%s)", hook.owner);
+    }
+
+    log_append("\n");
+
+    auto& request = stall_report.request;
+    if (request.name)
+    {
+        log_append("EE watchdog: Last Wayland request: %s@%u.%s from pid %d\n",
+            request.interface, request.id, request.name, (int)request.pid);
+    }
+
+    log_append("EE watchdog: Backtrace:\n");
+    log_flush();
+
+    /* Unlike backtrace_symbols(), does not allocate */
+    backtrace_symbols_fd(stall_report.frames, stall_report.frame_count,
+        STDOUT_FILENO);
+}
+
+void watch()
+{
+    auto interval = std::max(threshold / 4, std::chrono::milliseconds(5));
+    uint64_t reported_seq = 0;
+    while (true)
+    {
+        std::this_thread::sleep_for(interval);
+
+        /* Make sure start and seq belong to the same iteration */
+        uint64_t seq  = iteration_seq;
+        int64_t start = iteration_start;
+        if ((start == 0) || (seq != iteration_seq) || (seq == reported_seq))
+        {
+            continue;
+        }
+
+        auto elapsed = std::chrono::nanoseconds(now_ns() - start);
+        if (elapsed < threshold)
+        {
+            continue;
+        }
+
+        /* Report each stall only once */
+        reported_seq  = seq;
+        requested_seq = seq;
+        pthread_kill(main_thread, SIGUSR2);
+
+        /* Wait for the handler to capture the state of the main thread */
+        for (int i = 0; (i < 1000) && (report_seq != seq); i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        /* Withdraw the request. If the handler has claimed it already, it
+         * is still writing the report, so wait until it is done. */
+        if (requested_seq.exchange(0) != 0)
+        {
+            continue;
+        }
+
+        while (report_seq != seq)
+        {
+            std::this_thread::yield();
+        }
+
+        log_stall(std::chrono::duration_cast<
+            std::chrono::milliseconds>(elapsed).count());
+    }
+}
+
+void iteration_begin()
+{
+    last_request.name = nullptr;
+    iteration_seq++;
+    iteration_start = now_ns();
+}
+
+void iteration_end()
+{
+    auto duration = std::chrono::nanoseconds(now_ns() - iteration_start);
+    iteration_start = 0;
+
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(duration);
+    size_t bucket = 0;
+    while ((bucket < NUM_BUCKETS - 1) && (ms.count() >= (1ll << bucket)))
+    {
+        ++bucket;
+    }
+
+    histogram[bucket]++;
+}
+}
+
+void wf::watchdog::start(wl_display *display, int threshold_ms)
+{
+    threshold   = std::chrono::milliseconds(threshold_ms);
+    main_thread = pthread_self();
+    histogram.fill(0);
+
+    struct sigaction action = {};
+    action.sa_handler = handle_stall;
+    action.sa_flags   = SA_RESTART;
+    sigaction(SIGUSR2, &action, NULL);
+
+    hook_profiler::enable_tracking();
+    wl_display_add_protocol_logger(display, log_request, nullptr);
+
+    /* backtrace() loads libgcc on its first call, which is not safe in the
+     * signal handler */
+    void *frame;
+    backtrace(&frame, 1);
+
+    /* Detached, it sleeps most of the time and dies with the process. It
+     * inherits the signal mask, and must not receive any of the signals
+     * handled by the main thread, like SIGUSR1. */
+    sigset_t all_signals, previous;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_BLOCK, &all_signals, &previous);
+    std::thread(watch).detach();
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+}
+
+void wf::watchdog::run(wl_display *display)
+{
+    auto loop = wl_display_get_event_loop(display);
+    pollfd fd = {wl_event_loop_get_fd(loop), POLLIN, 0};
+
+    wl_event_loop_dispatch_idle(loop);
+    while (wf::get_core().get_current_state() != compositor_state_t::SHUTDOWN)
+    {
+        wl_display_flush_clients(display);
+
+        /* Wait outside of the measured iteration */
+        if ((poll(&fd, 1, -1) < 0) && (errno != EINTR))
+        {
+            LOGE("Failed to poll the event loop: ", strerror(errno));
+            break;
+        }
+
+        iteration_begin();
+        wl_event_loop_dispatch(loop, 0);
+        iteration_end();
+    }
+}
+
+void wf::watchdog::print_histogram()
+{
+    LOGI("Main loop iteration durations:");
+    for (size_t i = 0; i < NUM_BUCKETS; i++)
+    {
+        if (i == NUM_BUCKETS - 1)
+        {
+            LOGI(">=", 1 << (i - 1), "ms: ", histogram[i]);
+        } else
+        {
+            LOGI("<", 1 << i, "ms: ", histogram[i]);
+        }
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef WF_WATCHDOG_HPP
+#define WF_WATCHDOG_HPP
+
+#include <wayland-server.h>
+
+namespace wf
+{
+/**
+ * Detects stalls of the main loop.
+ *
+ * A separate thread watches the duration of the current main loop iteration.
+ * If it exceeds the threshold, the main thread is interrupted to capture which
+ * hooks are running, the last Wayland request it handled and a backtrace,
+ * which the watchdog thread then logs.
+ *
+ * In addition, a histogram of the iteration durations is kept.
+ */
+namespace watchdog
+{
+/**
+ * Start the watchdog thread. Has to be called before plugins are loaded, so
+ * that their hooks can be attributed.
+ */
+void start(wl_display *display, int threshold_ms);
+
+/**
+ * Run the main loop until the compositor shuts down, like wl_display_run(),
+ * but measure each iteration.
+ */
+void run(wl_display *display);
+
+/** Log the histogram of main loop iteration durations. */
+void print_histogram();
+}
+}
+
+#endif /* end of include guard: WF_WATCHDOG_HPP */
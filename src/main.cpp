@@ -15,6 +15,9 @@
 #include "wayfire/config-backend.hpp"
 #include "output/plugin-loader.hpp"
 #include "core/core-impl.hpp"
+#include "core/hook-profiler.hpp"
+#include "core/watchdog.hpp"
+#include "core/buffer-latency.hpp"
 #include "wayfire/output.hpp"
 
 wf_runtime_config runtime_config;
@@ -40,6 +43,16 @@ static void print_help()
         " -D,  --damage-debug      enable additional debug for damaged regions" <<
         std::endl;
     std::cout << " -R,  --damage-rerender   rerender damaged regions" << std::endl;
+    std::cout << " -T,  --virtual-clock     advance the frame time by exactly " <<
+        "one refresh cycle per frame (for benchmarks)" << std::endl;
+    std::cout << " -G,  --gl-debug          report GL errors via KHR_debug " <<
+        "instead of glGetError()" << std::endl;
+    std::cout << " -P,  --profile-hooks     measure CPU time of plugin hooks, " <<
+        "=<ms> warns per frame above budget, SIGUSR1 prints totals" << std::endl;
+    std::cout << " -W,  --watchdog          report main loop stalls longer than " <<
+        "=<ms> (default 1000), SIGUSR1 prints a histogram" << std::endl;
+    std::cout << " -L,  --buffer-latency    measure per-client buffer latency, " <<
+        "SIGUSR1 prints it" << std::endl;
     std::cout << " -v,  --version           print version and exit" << std::endl;
     exit(0);
 }
@@ -159,6 +172,40 @@ static std::optional<std::string> choose_socket(wl_display *display)
     return {};
 }
 
+static int print_statistics(int signal, void *data)
+{
+    if (runtime_config.profile_hooks)
+    {
+        LOGI("Hook profile (owner, kind, calls, total ms, max ms):");
+        for (auto& entry : wf::get_hook_profile())
+        {
+            LOGI(entry.owner, " ", entry.kind, " ", entry.calls, " ",
+                entry.total.count() / 1e6, " ", entry.max.count() / 1e6);
+        }
+    }
+
+    if (runtime_config.watchdog_ms > 0)
+    {
+        wf::watchdog::print_histogram();
+    }
+
+    if (runtime_config.buffer_latency)
+    {
+        LOGI("Buffer latency (pid, samples, average/max ms until rendered, "
+             "releases, average/max ms until released):");
+        for (auto& client : wf::get_buffer_latency())
+        {
+            LOGI(client.pid, " ", client.sample.count, " ",
+                client.sample.average().count() / 1e6, "/",
+                client.sample.max.count() / 1e6, " ", client.release.count, " ",
+                client.release.average().count() / 1e6, "/",
+                client.release.max.count() / 1e6);
+        }
+    }
+
+    return 0;
+}
+
 static wf::config_backend_t *load_backend(const std::string& backend)
 {
     auto [_, init_ptr] = wf::get_new_instance_handle(backend);
@@ -186,6 +233,11 @@ int main(int argc, char *argv[])
         {"debug", no_argument, NULL, 'd'},
         {"damage-debug", no_argument, NULL, 'D'},
         {"damage-rerender", no_argument, NULL, 'R'},
+        {"virtual-clock", no_argument, NULL, 'T'},
+        {"gl-debug", no_argument, NULL, 'G'},
+        {"profile-hooks", optional_argument, NULL, 'P'},
+        {"watchdog", optional_argument, NULL, 'W'},
+        {"buffer-latency", no_argument, NULL, 'L'},
         {"help", no_argument, NULL, 'h'},
         {"version", no_argument, NULL, 'v'},
         {0, 0, NULL, 0}
@@ -195,7 +247,7 @@ int main(int argc, char *argv[])
     std::string config_backend = WF_DEFAULT_CONFIG_BACKEND;
 
     int c, i;
-    while ((c = getopt_long(argc, argv, "c:B:dDhRv", opts, &i)) != -1)
+    while ((c = getopt_long(argc, argv, "c:B:dDGhLP::RTvW::", opts, &i)) != -1)
     {
         switch (c)
         {
@@ -215,6 +267,27 @@ int main(int argc, char *argv[])
             runtime_config.no_damage_track = true;
             break;
 
+          case 'T':
+            runtime_config.virtual_clock = true;
+            break;
+
+          case 'G':
+            runtime_config.gl_debug = true;
+            break;
+
+          case 'P':
+            runtime_config.profile_hooks  = true;
+            runtime_config.hook_budget_ms = optarg ? std::atof(optarg) : 0;
+            break;
+
+          case 'L':
+            runtime_config.buffer_latency = true;
+            break;
+
+          case 'W':
+            runtime_config.watchdog_ms = optarg ? std::atoi(optarg) : 1000;
+            break;
+
           case 'h':
             print_help();
             break;
@@ -262,6 +335,27 @@ int main(int argc, char *argv[])
     core.ev_loop = wl_display_get_event_loop(core.display);
     core.backend = wlr_backend_autocreate(core.display);
 
+    if (runtime_config.profile_hooks)
+    {
+        wf::hook_profiler::enable(runtime_config.hook_budget_ms);
+    }
+
+    if (runtime_config.watchdog_ms > 0)
+    {
+        wf::watchdog::start(core.display, runtime_config.watchdog_ms);
+    }
+
+    if (runtime_config.buffer_latency)
+    {
+        wf::buffer_latency::enable();
+    }
+
+    if (runtime_config.profile_hooks || (runtime_config.watchdog_ms > 0) ||
+        runtime_config.buffer_latency)
+    {
+        wl_event_loop_add_signal(core.ev_loop, SIGUSR1, print_statistics, NULL);
+    }
+
     int drm_fd = wlr_backend_get_drm_fd(core.backend);
     if (drm_fd < 0)
     {
@@ -321,7 +415,14 @@ int main(int argc, char *argv[])
     setenv("WAYLAND_DISPLAY", core.wayland_display.c_str(), 1);
     core.post_init();
 
-    wl_display_run(core.display);
+    if (runtime_config.watchdog_ms > 0)
+    {
+        wf::watchdog::run(core.display);
+        wf::watchdog::print_histogram();
+    } else
+    {
+        wl_display_run(core.display);
+    }
 
     /* Teardown */
     wl_display_destroy_clients(core.display);
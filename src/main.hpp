@@ -5,6 +5,14 @@ extern struct wf_runtime_config
 {
     bool no_damage_track = false;
     bool damage_debug    = false;
+    bool virtual_clock   = false;
+    bool gl_debug        = false;
+    bool profile_hooks   = false;
+    bool buffer_latency  = false;
+    /* Calls of plugin hooks longer than this are logged, 0 to disable */
+    double hook_budget_ms = 0;
+    /* Main loop stalls longer than this are reported, 0 to disable */
+    int watchdog_ms = 0;
 } runtime_config;
 
 #endif /* end of include guard: MAIN_HPP */
@@ -2,6 +2,7 @@
 #include "plugin-loader.hpp"
 #include "../core/seat/bindings-repository.hpp"
 
+#include <list>
 #include <unordered_set>
 #include <wayfire/nonstd/safe-list.hpp>
 
@@ -55,6 +56,12 @@ class output_impl_t : public output_t
     virtual ~output_impl_t();
     wayfire_view active_view;
 
+    /**
+     * Views on this output which have been focused, the most recently focused
+     * first. Kept up to date by wf::update_focus_mru().
+     */
+    std::list<wayfire_view> focus_mru;
+
     /**
      * Implementations of the public APIs
      */
@@ -111,7 +118,15 @@ class output_impl_t : public output_t
 };
 
 /**
- * Set the last focused timestamp of the view to now.
+ * Set the last focused timestamp of the view to now, and move it to the front
+ * of the focus MRU list of its output.
  */
 void update_focus_timestamp(wayfire_view view);
+
+/**
+ * Move the view to the focus MRU list of its current output, at the position
+ * given by its focus timestamp. Views without an output or which have never
+ * been focused are in no list.
+ */
+void update_focus_mru(wayfire_view view);
 }
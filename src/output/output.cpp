@@ -9,6 +9,7 @@
 #include "wayfire-shell.hpp"
 #include "../core/seat/input-manager.hpp"
 #include "../view/xdg-shell.hpp"
+#include "../view/view-impl.hpp"
 #include <wayfire/util/log.hpp>
 #include <wayfire/nonstd/wlroots-full.hpp>
 
@@ -50,20 +51,26 @@ std::string wf::output_t::to_string() const
  */
 static constexpr double MIN_VISIBILITY_PC = 0.1;
 
+/** Get the fraction of the view which is visible in the given workspace box. */
+static double get_visible_fraction(wayfire_view view, wf::geometry_t ws_box)
+{
+    auto bbox = view->transform_region(view->get_wm_geometry());
+    auto intersection = wf::geometry_intersection(bbox, ws_box);
+    double area = 1.0 * intersection.width * intersection.height;
+    area /= 1.0 * bbox.width * bbox.height;
+
+    return area;
+}
+
 void wf::output_impl_t::refocus(wayfire_view skip_view, uint32_t layers)
 {
     wf::point_t cur_ws = workspace->get_current_workspace();
+    auto ws_geometry   = render->get_ws_box(cur_ws);
     const auto& view_on_current_ws = [&] (wayfire_view view)
     {
         // Make sure the view is at least 10% visible on the
         // current workspace, to focus it
-        auto ws_geometry = render->get_ws_box(cur_ws);
-        auto bbox = view->transform_region(view->get_wm_geometry());
-        auto intersection = wf::geometry_intersection(bbox, ws_geometry);
-        double area = 1.0 * intersection.width * intersection.height;
-        area /= 1.0 * bbox.width * bbox.height;
-
-        return area >= MIN_VISIBILITY_PC;
+        return get_visible_fraction(view, ws_geometry) >= MIN_VISIBILITY_PC;
     };
 
     const auto& suitable_for_focus = [&] (wayfire_view view)
@@ -72,36 +79,88 @@ void wf::output_impl_t::refocus(wayfire_view skip_view, uint32_t layers)
                view->get_keyboard_focus_surface() && !view->minimized;
     };
 
-    auto views = workspace->get_views_on_workspace(cur_ws, layers);
-
-    // All views which might be focused
-    std::vector<wayfire_view> candidates;
-    for (auto toplevel : views)
+    // A view from the MRU list is a candidate if its toplevel would be
+    // returned by get_views_on_workspace(cur_ws, layers)
+    const auto& is_candidate = [&] (wayfire_view view)
     {
-        auto vs = toplevel->enumerate_views();
-        std::copy_if(vs.begin(), vs.end(), std::back_inserter(candidates),
-            suitable_for_focus);
-    }
+        if (!suitable_for_focus(view))
+        {
+            return false;
+        }
+
+        auto toplevel = view;
+        while (toplevel->parent)
+        {
+            toplevel = toplevel->parent;
+        }
+
+        return (workspace->get_view_layer(toplevel) & layers) &&
+               workspace->view_visible_on(toplevel, cur_ws);
+    };
 
     // Choose the best view.
     // All views which are mostly visible on the current workspace are preferred.
     // In case of ties, views with the latest focus timestamp are preferred.
-    auto it = std::max_element(candidates.begin(), candidates.end(),
-        [&] (wayfire_view view1, wayfire_view view2)
+    //
+    // Views which have been focused before are walked from the most recently
+    // focused one, so usually the first visible candidate is found right away.
+    wayfire_view fallback = nullptr;
+    for (auto& view : focus_mru)
     {
-        bool visible_1 = view_on_current_ws(view1);
-        bool visible_2 = view_on_current_ws(view2);
+        if (!is_candidate(view))
+        {
+            continue;
+        }
 
-        return std::make_tuple(visible_1, view1->last_focus_timestamp) <
-        std::make_tuple(visible_2, view2->last_focus_timestamp);
-    });
+        if (view_on_current_ws(view))
+        {
+            focus_view(view, (uint32_t)FOCUS_VIEW_NOBUMP);
+            return;
+        }
 
-    if (it == candidates.end())
+        if (!fallback)
+        {
+            fallback = view;
+        }
+    }
+
+    // No view focused before is visible. Look for a visible view which has
+    // never been focused, in stacking order, as those still win over views
+    // which are not visible.
+    wayfire_view first_unfocused = nullptr;
+    for (auto& toplevel : workspace->get_views_on_workspace(cur_ws, layers))
+    {
+        for (auto& view : toplevel->enumerate_views())
+        {
+            if ((view->last_focus_timestamp > 0) || !suitable_for_focus(view))
+            {
+                continue;
+            }
+
+            if (view_on_current_ws(view))
+            {
+                focus_view(view, (uint32_t)FOCUS_VIEW_NOBUMP);
+                return;
+            }
+
+            if (!first_unfocused)
+            {
+                first_unfocused = view;
+            }
+        }
+    }
+
+    if (!fallback)
+    {
+        fallback = first_unfocused;
+    }
+
+    if (!fallback)
     {
         focus_view(nullptr, 0u);
     } else
     {
-        focus_view(*it, (uint32_t)FOCUS_VIEW_NOBUMP);
+        focus_view(fallback, (uint32_t)FOCUS_VIEW_NOBUMP);
     }
 }
 
@@ -137,6 +196,11 @@ wf::output_t::~output_t()
 
 wf::output_impl_t::~output_impl_t()
 {
+    for (auto& view : focus_mru)
+    {
+        view->view_impl->focus_mru = nullptr;
+    }
+
     // Release plugins before bindings
     this->plugin.reset();
     this->bindings.reset();
@@ -274,7 +338,38 @@ void wf::update_focus_timestamp(wayfire_view view)
         timespec ts;
         clock_gettime(CLOCK_MONOTONIC, &ts);
         view->last_focus_timestamp = ts.tv_sec * 1'000'000'000ll + ts.tv_nsec;
+
+        update_focus_mru(view);
+    }
+}
+
+void wf::update_focus_mru(wayfire_view view)
+{
+    auto& priv = view->view_impl;
+    if (priv->focus_mru)
+    {
+        priv->focus_mru->erase(priv->focus_mru_position);
+        priv->focus_mru = nullptr;
+    }
+
+    auto output = dynamic_cast<wf::output_impl_t*>(view->get_output());
+    if (!output || (view->last_focus_timestamp == 0))
+    {
+        return;
     }
+
+    /* A view which was just focused goes to the front right away. Only views
+     * moved from another output need to skip more recently focused ones. */
+    auto& mru = output->focus_mru;
+    auto it   = mru.begin();
+    while ((it != mru.end()) &&
+           ((*it)->last_focus_timestamp > view->last_focus_timestamp))
+    {
+        ++it;
+    }
+
+    priv->focus_mru = &mru;
+    priv->focus_mru_position = mru.insert(it, view);
 }
 
 void wf::output_impl_t::focus_view(wayfire_view v, uint32_t flags)
@@ -8,11 +8,17 @@
 #include "wayfire/workspace-manager.hpp"
 #include "../core/seat/seat.hpp"
 #include "../core/opengl-priv.hpp"
+#include "../core/hook-profiler.hpp"
 #include "../main.hpp"
+#include "tile-damage.hpp"
 #include <algorithm>
+#include <map>
+#include <set>
+#include <unordered_set>
 #include <wayfire/nonstd/reverse.hpp>
 #include <wayfire/nonstd/safe-list.hpp>
 #include <wayfire/util/log.hpp>
+#include <wayfire/util/duration.hpp>
 #include <wayfire/nonstd/wlroots-full.hpp>
 
 namespace wf
@@ -29,6 +35,13 @@ struct output_damage_t
     wlr_output_damage *damage_manager;
     output_t *wo;
 
+    /* When enabled, the damage of the frame is kept in tile_damage instead of
+     * frame_damage. frame_damage is in the wlroots damage coordinate system,
+     * tile_damage in the same system, but anchored to the first workspace,
+     * see get_tile_offset(). */
+    wf::option_wrapper_t<bool> damage_tiles{"core/damage_tiles"};
+    tile_damage_t tile_damage;
+
     output_damage_t(output_t *output)
     {
         this->output = output->handle;
@@ -38,6 +51,100 @@ struct output_damage_t
 
         on_damage_destroy.set_callback([=] (void*) { damage_manager = nullptr; });
         on_damage_destroy.connect(&damage_manager->events.destroy);
+
+        damage_tiles.set_callback([=] ()
+        {
+            /* Move the damage accumulated so far to the new representation */
+            if (damage_tiles)
+            {
+                tile_damage.reset(get_tile_bounds());
+                tile_damage.add(frame_damage + get_tile_offset());
+                frame_damage.clear();
+            } else
+            {
+                auto offset = get_tile_offset();
+                frame_damage = tile_damage.to_region() +
+                    wf::point_t{-offset.x, -offset.y};
+                tile_damage.clear();
+            }
+        });
+    }
+
+    /**
+     * The tiles cover all workspaces. Their origin is the top-left corner of
+     * the first workspace, so that they stay in place when the current
+     * workspace changes.
+     */
+    wf::geometry_t get_tile_bounds() const
+    {
+        auto vsize = wo->workspace->get_workspace_grid_size();
+        auto res   = wo->get_screen_size();
+
+        return wf::geometry_t{0, 0,
+            vsize.width * res.width, vsize.height * res.height} *
+               wo->handle->scale;
+    }
+
+    /** @return The offset from the wlroots damage coordinates to the tiles. */
+    wf::point_t get_tile_offset() const
+    {
+        auto vp  = wo->workspace->get_current_workspace();
+        auto res = wo->get_screen_size();
+        auto current = wf::geometry_t{vp.x * res.width, vp.y * res.height, 0, 0} *
+            wo->handle->scale;
+
+        return {current.x, current.y};
+    }
+
+    /** Add already scaled damage to the frame damage. */
+    template<class T>
+    void add_frame_damage(const T& damage)
+    {
+        if (!damage_tiles)
+        {
+            frame_damage |= damage;
+            return;
+        }
+
+        auto bounds = get_tile_bounds();
+        if (bounds != tile_damage.get_bounds())
+        {
+            /* The output or the workspace grid was resized, the old tiles do
+             * not correspond to the new layout */
+            tile_damage.reset(bounds);
+            tile_damage.add(bounds);
+        }
+
+        tile_damage.add(damage + get_tile_offset());
+    }
+
+    /** @return The damage of the current frame, in the wlroots coordinates. */
+    wf::region_t get_frame_damage() const
+    {
+        if (damage_tiles)
+        {
+            auto offset = get_tile_offset();
+            return tile_damage.to_region() + wf::point_t{-offset.x, -offset.y};
+        }
+
+        return frame_damage;
+    }
+
+    /**
+     * @return The damage of the current frame on the visible part of the
+     *   output, in the wlroots coordinates. With tiles, only the tiles of the
+     *   current workspace are looked at.
+     */
+    wf::region_t get_output_frame_damage() const
+    {
+        if (damage_tiles)
+        {
+            auto offset = get_tile_offset();
+            auto visible = tile_damage.to_region(get_wlr_damage_box() + offset);
+            return visible + wf::point_t{-offset.x, -offset.y};
+        }
+
+        return frame_damage & get_wlr_damage_box();
     }
 
     /**
@@ -52,7 +159,7 @@ struct output_damage_t
 
         /* Wlroots expects damage after scaling */
         auto scaled_region = region * wo->handle->scale;
-        frame_damage |= scaled_region;
+        add_frame_damage(scaled_region);
         wlr_output_damage_add(damage_manager, scaled_region.to_pixman());
     }
 
@@ -65,7 +172,7 @@ struct output_damage_t
 
         /* Wlroots expects damage after scaling */
         auto scaled_box = box * wo->handle->scale;
-        frame_damage |= scaled_box;
+        add_frame_damage(scaled_box);
         wlr_output_damage_add_box(damage_manager, &scaled_box);
     }
 
@@ -103,10 +210,10 @@ struct output_damage_t
      */
     void accumulate_damage()
     {
-        frame_damage |= acc_damage;
+        add_frame_damage(acc_damage);
         if (runtime_config.no_damage_track)
         {
-            frame_damage |= get_wlr_damage_box();
+            add_frame_damage(get_wlr_damage_box());
         }
     }
 
@@ -121,7 +228,7 @@ struct output_damage_t
             return {};
         }
 
-        return frame_damage * (1.0 / wo->handle->scale);
+        return get_frame_damage() * (1.0 / wo->handle->scale);
     }
 
     /**
@@ -147,6 +254,7 @@ struct output_damage_t
             const_cast<wf::region_t&>(swap_damage).to_pixman());
         wlr_output_commit(output);
         frame_damage.clear();
+        tile_damage.clear();
     }
 
     bool force_next_frame = false;
@@ -191,6 +299,16 @@ struct output_damage_t
      */
     wf::region_t get_ws_damage(wf::point_t ws)
     {
+        if (damage_tiles)
+        {
+            /* Only look at the tiles of the workspace */
+            auto offset     = get_tile_offset();
+            auto scaled_box = get_ws_box(ws) * wo->handle->scale;
+            auto scaled     = tile_damage.to_region(scaled_box + offset) +
+                wf::point_t{-offset.x, -offset.y};
+            return (scaled * (1.0 / wo->handle->scale)) & get_ws_box(ws);
+        }
+
         auto scaled = frame_damage * (1.0 / wo->handle->scale);
 
         return scaled & get_ws_box(ws);
@@ -257,7 +375,10 @@ struct effect_hook_manager_t
     void run_effects(output_effect_type_t type)
     {
         effects[type].for_each([] (auto effect)
-        { (*effect)(); });
+        {
+            wf::hook_profiler::scope_t profile{effect, "effect"};
+            (*effect)();
+        });
     }
 };
 
@@ -355,7 +476,10 @@ struct postprocessing_manager_t
             next_buffer.allocate(output_width, output_height);
             OpenGL::render_end();
 
-            (*post)(post_buffers[last_buffer_idx], next_buffer);
+            {
+                wf::hook_profiler::scope_t profile{post, "post"};
+                (*post)(post_buffers[last_buffer_idx], next_buffer);
+            }
 
             last_buffer_idx  = next_buffer_idx;
             next_buffer_idx ^= 0b11; // alternate 1 and 2
@@ -664,6 +788,225 @@ struct repaint_delay_manager_t
     wf::wl_listener_wrapper on_present;
 };
 
+/**
+ * The frame clock provides a common time base for all animations on an output
+ * and keeps scheduling frames while there are running animations.
+ *
+ * The frame time is sampled once, at the start of each frame, so that all hooks
+ * which paint the same frame observe the same time. If the backend reports
+ * presentation timestamps in CLOCK_MONOTONIC, the frame time is the predicted
+ * presentation time of the frame, i.e. the last presentation plus one refresh
+ * cycle. With the virtual clock, the frame time advances by exactly one refresh
+ * cycle per frame, which makes users of get_frame_time() reproducible in
+ * benchmarks. wf::animation::duration_t is implemented in wf-config and keeps
+ * sampling the wall clock, only its scheduling is driven by the frame clock.
+ */
+struct frame_clock_t
+{
+    frame_clock_t(wf::output_t *output)
+    {
+        this->output = output;
+        this->frame_time = get_current_time();
+        this->monotonic_presentation =
+            wlr_backend_get_presentation_clock(wf::get_core_impl().backend) ==
+            CLOCK_MONOTONIC;
+
+        on_present.set_callback([&] (void *data)
+        {
+            auto ev = static_cast<wlr_output_event_present*>(data);
+            if (ev->refresh > 0)
+            {
+                this->refresh_msec = std::max(1, ev->refresh / 1'000'000);
+            }
+
+            if (ev->presented && ev->when)
+            {
+                this->last_present = timespec_to_msec(*ev->when);
+                this->has_present  = true;
+            }
+        });
+        on_present.connect(&output->handle->events.present);
+    }
+
+    /**
+     * Sample the time for a new frame.
+     */
+    void start_frame()
+    {
+        ++frame_sequence;
+        if (runtime_config.virtual_clock)
+        {
+            frame_time += refresh_msec;
+            return;
+        }
+
+        uint32_t now = get_current_time();
+        uint32_t next_frame = now;
+        if (has_present && monotonic_presentation)
+        {
+            uint32_t predicted = last_present + refresh_msec;
+            // The last presentation might be stale if the output was idle.
+            if ((int32_t)(predicted - now) > 0)
+            {
+                next_frame = predicted;
+            }
+        }
+
+        // Never go back in time, even if the prediction was too optimistic.
+        if ((int32_t)(next_frame - frame_time) > 0)
+        {
+            frame_time = next_frame;
+        }
+    }
+
+    uint32_t get_frame_time() const
+    {
+        return frame_time;
+    }
+
+    uint64_t get_frame_sequence() const
+    {
+        return frame_sequence;
+    }
+
+    void add_animation(wf::animation::duration_t *animation, wayfire_view view)
+    {
+        rem_animation(animation);
+        animations.push_back({animation, view});
+    }
+
+    void rem_animation(wf::animation::duration_t *animation)
+    {
+        auto it = std::remove_if(animations.begin(), animations.end(),
+            [=] (const tracked_animation_t& tracked)
+        {
+            return tracked.animation == animation;
+        });
+        animations.erase(it, animations.end());
+    }
+
+    /**
+     * Drop finished animations.
+     *
+     * @param has_renderer Whether a custom renderer is active, in which case
+     *   views on all workspaces may be visible.
+     * @return Whether another frame is needed, either because an animation is
+     *   still running, or because one has just finished and its final state
+     *   has to be drawn.
+     */
+    bool update_animations(bool has_renderer)
+    {
+        bool needs_frame = false;
+        auto it = animations.begin();
+        while (it != animations.end())
+        {
+            if (!it->view || is_visible(it->view, has_renderer))
+            {
+                needs_frame = true;
+            }
+
+            if (it->animation->running())
+            {
+                ++it;
+            } else
+            {
+                it = animations.erase(it);
+            }
+        }
+
+        return needs_frame;
+    }
+
+  private:
+    struct tracked_animation_t
+    {
+        wf::animation::duration_t *animation;
+        wayfire_view view;
+    };
+
+    std::vector<tracked_animation_t> animations;
+
+    wf::output_t *output;
+    uint32_t frame_time;
+    uint64_t frame_sequence = 0;
+    uint32_t last_present = 0;
+    bool has_present = false;
+    bool monotonic_presentation = false;
+    int refresh_msec = 16;
+
+    wf::wl_listener_wrapper on_present;
+
+    bool is_visible(wayfire_view view, bool has_renderer) const
+    {
+        if ((view->get_output() != output) || !view->is_visible())
+        {
+            return false;
+        }
+
+        auto bbox = view->get_bounding_box();
+        if (view->sticky)
+        {
+            return bbox & output->get_relative_geometry();
+        }
+
+        wf::geometry_t visible = output->get_relative_geometry();
+        if (has_renderer)
+        {
+            // Views on other workspaces may be visible through plugins like
+            // expo, which set a custom renderer.
+            auto vsize = output->workspace->get_workspace_grid_size();
+            auto cws   = output->workspace->get_current_workspace();
+            visible = {
+                -cws.x * visible.width, -cws.y * visible.height,
+                vsize.width * visible.width, vsize.height * visible.height,
+            };
+        }
+
+        return bbox & visible;
+    }
+};
+
+/**
+ * Decide whether a view can be scanned out, based on its geometry alone.
+ *
+ * Only the primary plane is used, so anything drawn above the view on the
+ * output needs compositing. Everything below the view is occluded by it, as
+ * long as it is opaque on the whole output.
+ *
+ * @param output_box The output, in output-local coordinates.
+ * @param geometry The output geometry of the view's main surface.
+ * @param opaque The opaque region of the view, in output-local coordinates.
+ * @param above The boxes of the surfaces drawn above the view's main surface,
+ *   in output-local coordinates. Empty boxes and boxes outside of the output
+ *   do not matter.
+ */
+static wf::scanout_result_t check_scanout_geometry(wf::geometry_t output_box,
+    wf::geometry_t geometry, const wf::region_t& opaque,
+    const std::vector<wf::geometry_t>& above)
+{
+    if (geometry != output_box)
+    {
+        return wf::SCANOUT_REJECT_GEOMETRY;
+    }
+
+    for (auto& box : above)
+    {
+        if ((box.width > 0) && (box.height > 0) && (box & output_box))
+        {
+            return wf::SCANOUT_REJECT_OCCLUDED;
+        }
+    }
+
+    wf::region_t non_opaque = output_box;
+    non_opaque ^= opaque;
+    if (!non_opaque.empty())
+    {
+        return wf::SCANOUT_REJECT_OPAQUE;
+    }
+
+    return wf::SCANOUT_SUCCESS;
+}
+
 class wf::render_manager::impl
 {
   public:
@@ -677,6 +1020,7 @@ class wf::render_manager::impl
     std::unique_ptr<postprocessing_manager_t> postprocessing;
     std::unique_ptr<depth_buffer_manager_t> depth_buffer_manager;
     std::unique_ptr<repaint_delay_manager_t> delay_manager;
+    std::unique_ptr<frame_clock_t> frame_clock;
 
     wf::option_wrapper_t<wf::color_t> background_color_opt;
 
@@ -688,10 +1032,12 @@ class wf::render_manager::impl
         postprocessing = std::make_unique<postprocessing_manager_t>(o);
         depth_buffer_manager = std::make_unique<depth_buffer_manager_t>();
         delay_manager = std::make_unique<repaint_delay_manager_t>(o);
+        frame_clock   = std::make_unique<frame_clock_t>(o);
 
         on_frame.set_callback([&] (void*)
         {
             delay_manager->start_frame();
+            frame_clock->start_frame();
 
             auto repaint_delay = delay_manager->get_delay();
             // Leave a bit of time for clients to render, see
@@ -699,6 +1045,7 @@ class wf::render_manager::impl
             if (repaint_delay < 1)
             {
                 paint();
+                hook_profiler::end_frame();
             } else
             {
                 output->handle->frame_pending = true;
@@ -706,6 +1053,7 @@ class wf::render_manager::impl
                 {
                     output->handle->frame_pending = false;
                     paint();
+                    hook_profiler::end_frame();
                     return false;
                 });
             }
@@ -725,6 +1073,11 @@ class wf::render_manager::impl
         output_damage->schedule_repaint();
     }
 
+    ~impl()
+    {
+        release_sampled();
+    }
+
     /* A stream for each workspace */
     std::vector<std::vector<workspace_stream_t>> default_streams;
     /* The stream pointing to the current workspace */
@@ -828,78 +1181,161 @@ class wf::render_manager::impl
 
             current_ws_stream = nonstd::make_observer(target_stream);
             workspace_stream_start(*current_ws_stream);
-        } else
+        } else if (!try_render_promoted_view(*current_ws_stream))
         {
             workspace_stream_update(*current_ws_stream);
         }
     }
 
     wayfire_view last_scanout;
+    scanout_stats_t scanout_stats;
+
     /**
-     * Try to directly scanout a view
+     * Find the view which could be scanned out, or the reason why direct
+     * scanout isn't possible.
+     *
+     * The candidate is the topmost mapped view whose main surface covers the
+     * whole output. Everything above its main surface, in other views or in
+     * its own subsurfaces, is collected and passed to check_scanout_geometry().
      */
-    bool do_direct_scanout()
+    scanout_result_t find_scanout_candidate(wayfire_view& candidate)
     {
-        const bool can_scanout =
-            !wf::get_core_impl().seat->drag_active &&
-            !output_inhibit_counter &&
-            !renderer &&
-            effects->can_scanout() &&
-            postprocessing->can_scanout() &&
-            output->handle->software_cursor_locks == 0;
+        if (wf::get_core_impl().seat->drag_active ||
+            (output->handle->software_cursor_locks > 0))
+        {
+            return SCANOUT_REJECT_CURSOR;
+        }
 
-        if (!can_scanout)
+        if (output_inhibit_counter || renderer || !effects->can_scanout() ||
+            !postprocessing->can_scanout())
         {
-            return false;
+            return SCANOUT_REJECT_PLUGIN;
         }
 
+        auto output_box = output->get_relative_geometry();
         auto views = output->workspace->get_views_on_workspace(
             output->workspace->get_current_workspace(), wf::VISIBLE_LAYERS);
 
-        if (views.empty())
+        // Collect the surfaces of the view, from the top, until @stop_at
+        std::vector<wf::geometry_t> above;
+        const auto& add_surfaces = [&] (wayfire_view view,
+                                        wf::surface_interface_t *stop_at)
         {
-            return false;
+            if (view->has_transformer())
+            {
+                above.push_back(view->get_bounding_box());
+                return;
+            }
+
+            auto origin = wf::origin(view->get_output_geometry());
+            for (auto& child : view->enumerate_surfaces(origin))
+            {
+                if (child.surface == stop_at)
+                {
+                    break;
+                }
+
+                auto size = child.surface->get_size();
+                above.push_back({child.position.x, child.position.y,
+                    size.width, size.height});
+            }
+        };
+
+        candidate = nullptr;
+        for (auto& toplevel : views)
+        {
+            for (auto& view : toplevel->enumerate_views(false))
+            {
+                if (!view->is_visible())
+                {
+                    continue;
+                }
+
+                if (view->is_mapped() &&
+                    (view->get_output_geometry() == output_box))
+                {
+                    candidate = view;
+                    add_surfaces(view, view.get());
+                    break;
+                }
+
+                add_surfaces(view, nullptr);
+            }
+
+            if (candidate)
+            {
+                break;
+            }
         }
 
-        auto candidate = views.front();
+        if (!candidate)
+        {
+            return above.empty() ?
+                   SCANOUT_REJECT_NO_VIEW : SCANOUT_REJECT_GEOMETRY;
+        }
 
-        // The candidate must cover the whole output
-        if (candidate->get_output_geometry() != output->get_relative_geometry())
+        if (candidate->has_transformer())
         {
-            return false;
+            return SCANOUT_REJECT_TRANSFORM;
         }
 
-        // The view must have only a single surface and no transformers
-        if (candidate->has_transformer() ||
-            !candidate->priv->surface_children_above.empty() ||
-            !candidate->children.empty())
+        auto result = check_scanout_geometry(output_box,
+            candidate->get_output_geometry(),
+            candidate->get_opaque_region(wf::point_t{0, 0}), above);
+        if (result != SCANOUT_SUCCESS)
         {
-            return false;
+            return result;
         }
 
         // Must have a wlr surface with the correct scale and transform
         auto surface = candidate->get_wlr_surface();
-        if (!surface ||
+        if (!surface || !surface->buffer ||
             (surface->current.scale != output->handle->scale) ||
             (surface->current.transform != output->handle->transform))
         {
-            return false;
+            return SCANOUT_REJECT_SURFACE;
         }
 
-        // Finally, the opaque region must be the full surface.
-        wf::region_t non_opaque = output->get_relative_geometry();
-        non_opaque ^= candidate->get_opaque_region(wf::point_t{0, 0});
-        if (!non_opaque.empty())
+        return SCANOUT_SUCCESS;
+    }
+
+    void count_scanout_result(scanout_result_t result)
+    {
+        if (result != scanout_stats.last)
+        {
+            LOGD("Direct scanout on ", output->to_string(), ": ",
+                scanout_result_to_string(result));
+        }
+
+        scanout_stats.count[result]++;
+        scanout_stats.last = result;
+    }
+
+    /**
+     * Try to directly scanout a view
+     */
+    bool do_direct_scanout()
+    {
+        wayfire_view candidate;
+        auto result = find_scanout_candidate(candidate);
+        if (result != SCANOUT_SUCCESS)
         {
+            count_scanout_result(result);
             return false;
         }
 
+        auto surface = candidate->get_wlr_surface();
         wlr_presentation_surface_sampled_on_output(
             wf::get_core().protocols.presentation, surface, output->handle);
         wlr_output_attach_buffer(output->handle, &surface->buffer->base);
 
         if (wlr_output_commit(output->handle))
         {
+            if (auto wlr_base = dynamic_cast<wlr_surface_base_t*>(candidate.get()))
+            {
+                wlr_base->latency.sampled(surface);
+            }
+
             if (candidate != last_scanout)
             {
                 last_scanout = candidate;
@@ -907,10 +1343,12 @@ class wf::render_manager::impl
                     candidate->get_title(), ",", candidate->get_app_id());
             }
 
+            count_scanout_result(SCANOUT_SUCCESS);
             return true;
         } else
         {
             LOGD("Failed to scan out view ", candidate->get_title());
+            count_scanout_result(SCANOUT_REJECT_COMMIT);
             return false;
         }
     }
@@ -932,14 +1370,13 @@ class wf::render_manager::impl
     {
         if (renderer)
         {
+            wf::hook_profiler::scope_t profile{&renderer, "render"};
             renderer(postprocessing->get_target_framebuffer());
             /* TODO: let custom renderers specify what they want to repaint... */
             swap_damage |= output_damage->get_wlr_damage_box();
         } else
         {
-            swap_damage =
-                output_damage->get_scheduled_damage() * output->handle->scale;
-            swap_damage &= output_damage->get_wlr_damage_box();
+            swap_damage = output_damage->get_output_frame_damage();
             default_renderer();
         }
     }
@@ -970,6 +1407,8 @@ class wf::render_manager::impl
     void paint()
     {
         /* Part 1: frame setup: query damage, etc. */
+        ++wf::get_core_impl().paint_sequence;
+        release_sampled();
         effects->run_effects(OUTPUT_EFFECT_PRE);
         effects->run_effects(OUTPUT_EFFECT_DAMAGE);
 
@@ -977,6 +1416,7 @@ class wf::render_manager::impl
         {
             // Yet another optimization: if we can directly scanout, we should
             // stop the rest of the repaint cycle.
+            schedule_animation_frame();
             return;
         } else
         {
@@ -1043,6 +1483,7 @@ class wf::render_manager::impl
 
         /* Part 6: finalize frame: swap buffers, send frame_done, etc */
         OpenGL::unbind_output();
+        flush_sampled_surfaces();
         output_damage->swap_buffers(swap_damage);
         swap_damage.clear();
         post_paint();
@@ -1059,38 +1500,105 @@ class wf::render_manager::impl
         {
             output_damage->schedule_repaint();
         }
+
+        schedule_animation_frame();
     }
 
     /**
-     * Send frame_done to clients.
+     * Schedule the next frame if there are animations which need it.
      */
-    void send_frame_done()
+    void schedule_animation_frame()
     {
-        /* TODO: do this only if the view isn't fully occluded by another */
-        std::vector<wayfire_view> visible_views;
-        if (renderer)
-        {
-            visible_views = output->workspace->get_views_in_layer(
-                wf::VISIBLE_LAYERS);
-        } else
+        if (frame_clock->update_animations(renderer != nullptr))
         {
-            visible_views = output->workspace->get_views_on_workspace(
-                output->workspace->get_current_workspace(),
-                wf::MIDDLE_LAYERS);
+            output_damage->schedule_repaint();
+        }
+    }
 
-            // send to all panels/backgrounds/etc
-            auto additional_views = output->workspace->get_views_in_layer(
-                wf::BELOW_LAYERS | wf::ABOVE_LAYERS);
+    void add_animation(wf::animation::duration_t *animation, wayfire_view view)
+    {
+        frame_clock->add_animation(animation, view);
+        output_damage->schedule_repaint();
+    }
+
+    /**
+     * Frame callbacks are sent at a different rate depending on how visible
+     * the views are:
+     *
+     * 1. Views on the current workspace and in the layers above and below the
+     *    workspace get a frame callback each frame.
+     * 2. Views on workspaces which are streamed by a plugin (e.g expo or cube)
+     *    get a share of the frames, proportional to the size at which their
+     *    workspace is displayed, as reported by workspace_stream_update().
+     * 3. Views on all other workspaces get frame callbacks at a low rate,
+     *    configured with core/hidden_workspace_frame_rate, so that they do not
+     *    stall completely. A timer is used for them, so that they get frame
+     *    callbacks even if the output isn't repainted.
+     */
+    struct ws_frame_info_t
+    {
+        /* The last frame in which the stream of the workspace was updated */
+        uint64_t last_stream_frame = 0;
+        /* The fraction of the output the workspace was last displayed at */
+        float fraction = 1.0;
+        /* Accumulated fraction of a frame callback */
+        float credit   = 0.0;
+    };
+
+    std::vector<std::vector<ws_frame_info_t>> ws_frame_info;
+    wf::option_wrapper_t<int> hidden_frame_rate{
+        "core/hidden_workspace_frame_rate"};
+    wf::wl_timer hidden_frame_timer;
+
+    ws_frame_info_t& get_ws_frame_info(wf::point_t ws)
+    {
+        auto wsize = output->workspace->get_workspace_grid_size();
+        if ((int)ws_frame_info.size() != wsize.width)
+        {
+            ws_frame_info.resize(wsize.width);
+        }
 
-            visible_views.insert(visible_views.end(),
-                additional_views.begin(), additional_views.end());
+        for (auto& column : ws_frame_info)
+        {
+            column.resize(wsize.height);
         }
 
-        timespec repaint_ended;
+        return ws_frame_info[ws.x][ws.y];
+    }
+
+    /**
+     * Check whether the stream of the given workspace is currently displayed.
+     * The repaint might be delayed after sending frame callbacks, so streams
+     * updated in the previous frame are also considered.
+     */
+    bool is_workspace_streamed(wf::point_t ws)
+    {
+        auto& info = get_ws_frame_info(ws);
+        return renderer && (info.last_stream_frame > 0) &&
+               (info.last_stream_frame + 1 >= frame_clock->get_frame_sequence());
+    }
+
+    void note_stream_update(const workspace_stream_t& stream,
+        float scale_x, float scale_y)
+    {
+        auto& info = get_ws_frame_info(stream.ws);
+        info.last_stream_frame = frame_clock->get_frame_sequence();
+        info.fraction = std::clamp(std::max(scale_x, scale_y), 0.0f, 1.0f);
+    }
+
+    static timespec get_frame_done_time()
+    {
+        timespec now;
         clockid_t presentation_clock =
             wlr_backend_get_presentation_clock(wf::get_core_impl().backend);
-        clock_gettime(presentation_clock, &repaint_ended);
-        for (auto& v : visible_views)
+        clock_gettime(presentation_clock, &now);
+        return now;
+    }
+
+    static void send_frame_done(const std::vector<wayfire_view>& views,
+        const timespec& frame_end)
+    {
+        for (auto& v : views)
         {
             for (auto& view : v->enumerate_views())
             {
@@ -1101,17 +1609,227 @@ class wf::render_manager::impl
 
                 for (auto& child : view->enumerate_surfaces())
                 {
-                    child.surface->send_frame_done(repaint_ended);
+                    child.surface->send_frame_done(frame_end);
                 }
             }
         }
     }
 
-    /* Workspace stream implementation */
+    /**
+     * Send frame_done to clients on the current and on streamed workspaces.
+     */
+    void send_frame_done()
+    {
+        /* TODO: do this only if the view isn't fully occluded by another */
+        auto cws   = output->workspace->get_current_workspace();
+        auto wsize = output->workspace->get_workspace_grid_size();
+
+        // send to all panels/backgrounds/etc
+        std::vector<wayfire_view> visible_views =
+            output->workspace->get_views_in_layer(
+                wf::BELOW_LAYERS | wf::ABOVE_LAYERS);
+
+        std::set<wayfire_view> middle_views;
+        bool has_hidden_workspaces = false;
+        for (int i = 0; i < wsize.width; i++)
+        {
+            for (int j = 0; j < wsize.height; j++)
+            {
+                wf::point_t ws = {i, j};
+                if (ws != cws)
+                {
+                    if (!is_workspace_streamed(ws))
+                    {
+                        has_hidden_workspaces = true;
+                        continue;
+                    }
+
+                    auto& info = get_ws_frame_info(ws);
+                    info.credit += info.fraction;
+                    if (info.credit < 1.0)
+                    {
+                        continue;
+                    }
+
+                    info.credit -= 1.0;
+                }
+
+                for (auto& view : output->workspace->get_views_on_workspace(ws,
+                    wf::MIDDLE_LAYERS))
+                {
+                    middle_views.insert(view);
+                }
+            }
+        }
+
+        visible_views.insert(visible_views.end(),
+            middle_views.begin(), middle_views.end());
+        send_frame_done(visible_views, get_frame_done_time());
+
+        if (has_hidden_workspaces && (hidden_frame_rate > 0) &&
+            !hidden_frame_timer.is_connected())
+        {
+            hidden_frame_timer.set_timeout(1000 / std::min(1000,
+                (int)hidden_frame_rate), [=] ()
+            {
+                return send_hidden_frame_done();
+            });
+        }
+    }
+
+    /**
+     * Send frame_done to clients on workspaces which are not visible.
+     *
+     * @return Whether there are still views on hidden workspaces.
+     */
+    bool send_hidden_frame_done()
+    {
+        if (hidden_frame_rate <= 0)
+        {
+            return false;
+        }
+
+        auto cws   = output->workspace->get_current_workspace();
+        auto wsize = output->workspace->get_workspace_grid_size();
+
+        std::set<wayfire_view> visible;
+        for (auto& view : output->workspace->get_views_on_workspace(cws,
+            wf::MIDDLE_LAYERS))
+        {
+            visible.insert(view);
+        }
+
+        std::set<wayfire_view> hidden;
+        for (int i = 0; i < wsize.width; i++)
+        {
+            for (int j = 0; j < wsize.height; j++)
+            {
+                wf::point_t ws = {i, j};
+                if ((ws == cws) || is_workspace_streamed(ws))
+                {
+                    continue;
+                }
+
+                for (auto& view : output->workspace->get_views_on_workspace(ws,
+                    wf::MIDDLE_LAYERS))
+                {
+                    if (!visible.count(view))
+                    {
+                        hidden.insert(view);
+                    }
+                }
+            }
+        }
+
+        send_frame_done({hidden.begin(), hidden.end()}, get_frame_done_time());
+        return !hidden.empty();
+    }
+
+    /**
+     * The state of a view which determines how it looks on a workspace stream.
+     * Commits and damage bump the content version.
+     */
+    struct view_fingerprint_t
+    {
+        wf::view_interface_t *view;
+        uint64_t content_version;
+        wf::geometry_t bbox;
+        bool mapped;
+        bool visible;
+
+        bool operator ==(const view_fingerprint_t& other) const
+        {
+            return view == other.view &&
+                   content_version == other.content_version &&
+                   bbox == other.bbox && mapped == other.mapped &&
+                   visible == other.visible;
+        }
+    };
+
+    /** What was on the workspace when a stream was last rendered. */
+    struct stream_fingerprint_t
+    {
+        std::vector<view_fingerprint_t> views;
+        wf::color_t background;
+        /* Plugins often change transformer parameters, like alpha, without
+         * damaging the view, so views with transformers can't be cached. */
+        bool has_transformed = false;
+
+        bool operator ==(const stream_fingerprint_t& other) const
+        {
+            return views == other.views && background == other.background;
+        }
+    };
+
+    std::map<const workspace_stream_t*, stream_fingerprint_t> stream_fingerprints;
+    stream_stats_t stream_stats;
+
+    stream_fingerprint_t get_stream_fingerprint(workspace_stream_t& stream)
+    {
+        stream_fingerprint_t fingerprint;
+        fingerprint.background = (stream.background.a < 0) ?
+            (wf::color_t)background_color_opt : stream.background;
+
+        auto views = output->workspace->get_views_on_workspace(stream.ws,
+            wf::VISIBLE_LAYERS);
+        for (auto& v : views)
+        {
+            for (auto& view : v->enumerate_views(false))
+            {
+                fingerprint.views.push_back({view.get(),
+                    view->view_impl->content_version, view->get_bounding_box(),
+                    view->is_mapped(), view->is_visible()});
+                fingerprint.has_transformed |= view->has_transformer();
+            }
+        }
+
+        return fingerprint;
+    }
+
+    /**
+     * Check whether a damaged stream actually needs to be repainted, and
+     * remember its current contents if it does.
+     *
+     * Only streams which render to their own buffer keep their contents. Drag
+     * icons are not tracked, so streams are always repainted while there is
+     * one.
+     */
+    bool stream_needs_repaint(workspace_stream_t& stream,
+        const wf::framebuffer_t& fb)
+    {
+        auto& drag_icon = wf::get_core_impl().seat->drag_icon;
+        bool has_drag_icon = wf::get_xwayland_drag_icon() ||
+            (drag_icon && drag_icon->is_mapped());
+        if ((stream.buffer.tex == 0) || (fb.tex != stream.buffer.tex) ||
+            has_drag_icon)
+        {
+            stream_fingerprints.erase(&stream);
+            return true;
+        }
+
+        auto fingerprint = get_stream_fingerprint(stream);
+        if (fingerprint.has_transformed)
+        {
+            stream_fingerprints.erase(&stream);
+            return true;
+        }
+
+        auto it = stream_fingerprints.find(&stream);
+        if ((it != stream_fingerprints.end()) && (it->second == fingerprint))
+        {
+            return false;
+        }
+
+        stream_fingerprints[&stream] = std::move(fingerprint);
+        return true;
+    }
+
+    /* Workspace stream implementation */
     void workspace_stream_start(workspace_stream_t& stream)
     {
         stream.running = true;
         stream.scale_x = stream.scale_y = 1;
+        stream_fingerprints.erase(&stream);
 
         /* damage the whole workspace region, so that we get a full repaint
          * when updating the workspace */
@@ -1267,52 +1985,145 @@ class wf::render_manager::impl
      * Iterate all visible surfaces on the workspace, and check whether
      * they need repaint.
      */
-    void check_schedule_surfaces(workspace_stream_repaint_t& repaint,
-        workspace_stream_t& stream)
+    /**
+     * Repaint the damaged parts of the stream with the given views, ordered
+     * from the top, and the drag icon above them. The workspace-stream-pre and
+     * workspace-stream-post signals are emitted around the repaint.
+     */
+    void repaint_stream_views(workspace_stream_t& stream,
+        workspace_stream_repaint_t& repaint,
+        const std::vector<wayfire_view>& views)
     {
-        auto views = output->workspace->get_views_on_workspace(stream.ws,
-            wf::VISIBLE_LAYERS);
+        {
+            stream_signal_t data(stream.ws, repaint.ws_damage, repaint.fb);
+            output->render->emit_signal("workspace-stream-pre", &data);
+        }
 
         schedule_drag_icon(repaint);
-        for (auto& v : views)
+        for (auto& view : views)
         {
-            for (auto& view : v->enumerate_views(false))
+            schedule_view(repaint, view);
+        }
+
+        if (stream.background.a < 0)
+        {
+            clear_empty_areas(repaint, background_color_opt);
+        } else
+        {
+            clear_empty_areas(repaint, stream.background);
+        }
+
+        render_views(repaint);
+
+        unschedule_drag_icon();
+        {
+            stream_signal_t data(stream.ws, repaint.ws_damage, repaint.fb);
+            output->render->emit_signal("workspace-stream-post", &data);
+        }
+    }
+
+    /**
+     * Check whether a single view needs repaint, and add it to the repaint list.
+     */
+    void schedule_view(workspace_stream_repaint_t& repaint, wayfire_view view)
+    {
+        wf::point_t view_delta{0, 0};
+        if (!view->is_visible() || repaint.ws_damage.empty())
+        {
+            return;
+        }
+
+        if (view->sticky)
+        {
+            view_delta = {repaint.ws_dx, repaint.ws_dy};
+        }
+
+        /* We use the snapshot of a view on either of the following
+         * conditions:
+         *
+         * 1. The view has a transform
+         * 2. The view is visible, but not mapped
+         *    => it is snapshotted and kept alive by some plugin
+         */
+        if (view->has_transformer() || !view->is_mapped())
+        {
+            /* Snapshotted views include all of their subsurfaces, so we
+             * don't recursively go into subsurfaces. */
+            schedule_snapshotted_view(repaint, view, view_delta);
+        } else
+        {
+            /* Make sure view position is relative to the workspace
+             * being rendered */
+            auto obox = view->get_output_geometry() + view_delta;
+            for (auto& child : view->enumerate_surfaces({obox.x, obox.y}))
             {
-                wf::point_t view_delta{0, 0};
-                if (!view->is_visible() || repaint.ws_damage.empty())
-                {
-                    continue;
-                }
+                schedule_surface(repaint, child.surface, child.position);
+            }
+        }
+    }
 
-                if (view->sticky)
-                {
-                    view_delta = {repaint.ws_dx, repaint.ws_dy};
-                }
+    /**
+     * Fast path for the current workspace, when a fullscreen view covers the
+     * whole output with opaque contents. Only the fullscreen view and the layers
+     * above it are looked at.
+     *
+     * A transformer may make the fullscreen view reveal the views below it, so
+     * the fast path is used only if none of the views it renders has one.
+     *
+     * @return false if the fast path cannot be used.
+     */
+    bool try_render_promoted_view(workspace_stream_t& stream)
+    {
+        auto promoted = output->workspace->get_promoted_views(stream.ws);
+        if (promoted.empty())
+        {
+            return false;
+        }
 
-                /* We use the snapshot of a view on either of the following
-                 * conditions:
-                 *
-                 * 1. The view has a transform
-                 * 2. The view is visible, but not mapped
-                 *    => it is snapshotted and kept alive by some plugin
-                 */
-                if (view->has_transformer() || !view->is_mapped())
-                {
-                    /* Snapshotted views include all of their subsurfaces, so we
-                     * don't recursively go into subsurfaces. */
-                    schedule_snapshotted_view(repaint, view, view_delta);
-                } else
-                {
-                    /* Make sure view position is relative to the workspace
-                     * being rendered */
-                    auto obox = view->get_output_geometry() + view_delta;
-                    for (auto& child : view->enumerate_surfaces({obox.x, obox.y}))
-                    {
-                        schedule_surface(repaint, child.surface, child.position);
-                    }
-                }
+        auto fullscreen = promoted.front();
+        auto output_box = output->get_relative_geometry();
+        if (!fullscreen->is_mapped() || !fullscreen->is_visible() ||
+            (fullscreen->get_output_geometry() != output_box))
+        {
+            return false;
+        }
+
+        wf::region_t non_opaque = output_box;
+        non_opaque ^= fullscreen->get_opaque_region(wf::point_t{0, 0});
+        if (!non_opaque.empty())
+        {
+            return false;
+        }
+
+        std::vector<wayfire_view> views;
+        for (auto& v : output->workspace->get_views_on_workspace(stream.ws,
+            wf::LAYER_DESKTOP_WIDGET | wf::LAYER_LOCK | wf::LAYER_UNMANAGED))
+        {
+            auto vs = v->enumerate_views(false);
+            views.insert(views.end(), vs.begin(), vs.end());
+        }
+
+        auto vs = fullscreen->enumerate_views(false);
+        views.insert(views.end(), vs.begin(), vs.end());
+        for (auto& view : views)
+        {
+            if (view->is_visible() && view->has_transformer())
+            {
+                return false;
             }
         }
+
+        note_stream_update(stream, 1, 1);
+        workspace_stream_repaint_t repaint =
+            calculate_repaint_for_stream(stream, 1, 1);
+        if (repaint.ws_damage.empty())
+        {
+            return true;
+        }
+
+        repaint_stream_views(stream, repaint, views);
+
+        return true;
     }
 
     /**
@@ -1340,7 +2151,12 @@ class wf::render_manager::impl
         }
 
         OpenGL::render_begin();
-        stream.buffer.allocate(output->handle->width, output->handle->height);
+        if (stream.buffer.allocate(output->handle->width, output->handle->height))
+        {
+            /* The previous contents are gone */
+            stream_fingerprints.erase(&stream);
+        }
+
         OpenGL::render_end();
 
         repaint.fb = postprocessing->get_target_framebuffer();
@@ -1374,14 +2190,65 @@ class wf::render_manager::impl
         OpenGL::render_end();
     }
 
+    /* Views and surfaces sampled in the current frame. A view may be rendered
+     * several times per frame, for example in multiple workspace streams, so
+     * they are collected and reported to the presentation-time protocol only
+     * once, when the frame is submitted. Plugins may close views in the
+     * hooks which run in between, so a reference is held for each view. */
+    std::set<wayfire_view> sampled_views;
+    std::unordered_set<wlr_surface*> sampled_surfaces;
+
+    void sample_view(wayfire_view view)
+    {
+        if (sampled_views.insert(view).second)
+        {
+            view->take_ref();
+        }
+    }
+
+    /** Forget the sampled views and surfaces, without reporting them. */
+    void release_sampled()
+    {
+        auto views = std::move(sampled_views);
+        sampled_views.clear();
+        sampled_surfaces.clear();
+        for (auto& view : views)
+        {
+            view->unref();
+        }
+    }
+
     void send_sampled_on_output(wf::surface_interface_t *surface)
     {
         if (surface->get_wlr_surface() != nullptr)
+        {
+            sampled_surfaces.insert(surface->get_wlr_surface());
+        }
+    }
+
+    /**
+     * Report all surfaces sampled in this frame. wlroots attaches the feedback
+     * to the next commit of the output, so this must be called before the
+     * buffers are swapped.
+     */
+    void flush_sampled_surfaces()
+    {
+        for (auto& view : sampled_views)
+        {
+            for (auto& child : view->enumerate_surfaces({0, 0}))
+            {
+                send_sampled_on_output(child.surface);
+            }
+        }
+
+        for (auto& surface : sampled_surfaces)
         {
             wlr_presentation_surface_sampled_on_output(
                 wf::get_core_impl().protocols.presentation,
-                surface->get_wlr_surface(), output->handle);
+                surface, output->handle);
         }
+
+        release_sampled();
     }
 
     void render_views(workspace_stream_repaint_t& repaint)
@@ -1394,10 +2261,7 @@ class wf::render_manager::impl
             {
                 repaint.fb.geometry = fb_geometry + ds->pos;
                 ds->view->render_transformed(repaint.fb, ds->damage);
-                for (auto& child : ds->view->enumerate_surfaces({0, 0}))
-                {
-                    send_sampled_on_output(child.surface);
-                }
+                sample_view(ds->view->self());
             } else
             {
                 repaint.fb.geometry = fb_geometry;
@@ -1414,6 +2278,7 @@ class wf::render_manager::impl
     void workspace_stream_update(workspace_stream_t& stream,
         float scale_x = 1, float scale_y = 1)
     {
+        note_stream_update(stream, scale_x, scale_y);
         workspace_stream_repaint_t repaint =
             calculate_repaint_for_stream(stream, scale_x, scale_y);
 
@@ -1422,42 +2287,42 @@ class wf::render_manager::impl
             return;
         }
 
+        if (!stream_needs_repaint(stream, repaint.fb))
         {
-            stream_signal_t data(stream.ws, repaint.ws_damage, repaint.fb);
-            output->render->emit_signal("workspace-stream-pre", &data);
+            stream_stats.skipped++;
+            return;
         }
 
-        check_schedule_surfaces(repaint, stream);
-
-        if (stream.background.a < 0)
+        stream_stats.rendered++;
+        std::vector<wayfire_view> views;
+        for (auto& v : output->workspace->get_views_on_workspace(stream.ws,
+            wf::VISIBLE_LAYERS))
         {
-            clear_empty_areas(repaint, background_color_opt);
-        } else
-        {
-            clear_empty_areas(repaint, stream.background);
+            auto vs = v->enumerate_views(false);
+            views.insert(views.end(), vs.begin(), vs.end());
         }
 
-        render_views(repaint);
-
-        unschedule_drag_icon();
-        {
-            stream_signal_t data(stream.ws, repaint.ws_damage, repaint.fb);
-            output->render->emit_signal("workspace-stream-post", &data);
-        }
+        repaint_stream_views(stream, repaint, views);
     }
 
     void workspace_stream_stop(workspace_stream_t& stream)
     {
         stream.running = false;
+        stream_fingerprints.erase(&stream);
     }
 };
 
 render_manager::render_manager(output_t *o) :
     pimpl(new impl(o))
 {}
-render_manager::~render_manager() = default;
+render_manager::~render_manager()
+{
+    hook_profiler::remove_owner(&pimpl->renderer);
+}
+
 void render_manager::set_renderer(render_hook_t rh)
 {
+    hook_profiler::set_owner(&pimpl->renderer, __builtin_return_address(0));
     pimpl->set_renderer(rh);
 }
 
@@ -1476,6 +2341,76 @@ void render_manager::schedule_redraw()
     pimpl->output_damage->schedule_repaint();
 }
 
+uint32_t render_manager::get_frame_time() const
+{
+    return pimpl->frame_clock->get_frame_time();
+}
+
+uint64_t render_manager::get_frame_sequence() const
+{
+    return pimpl->frame_clock->get_frame_sequence();
+}
+
+const scanout_stats_t& render_manager::get_scanout_stats() const
+{
+    return pimpl->scanout_stats;
+}
+
+const stream_stats_t& render_manager::get_stream_stats() const
+{
+    return pimpl->stream_stats;
+}
+
+const char *scanout_result_to_string(scanout_result_t result)
+{
+    switch (result)
+    {
+      case SCANOUT_SUCCESS:
+        return "success";
+
+      case SCANOUT_REJECT_PLUGIN:
+        return "a plugin needs compositing";
+
+      case SCANOUT_REJECT_CURSOR:
+        return "software cursor or drag icon";
+
+      case SCANOUT_REJECT_NO_VIEW:
+        return "no visible view";
+
+      case SCANOUT_REJECT_GEOMETRY:
+        return "no view covers the output";
+
+      case SCANOUT_REJECT_OCCLUDED:
+        return "another view or subsurface is visible above";
+
+      case SCANOUT_REJECT_TRANSFORM:
+        return "the view has a transformer";
+
+      case SCANOUT_REJECT_SURFACE:
+        return "surface scale, transform or buffer mismatch";
+
+      case SCANOUT_REJECT_OPAQUE:
+        return "the view is not opaque";
+
+      case SCANOUT_REJECT_COMMIT:
+        return "the backend rejected the buffer";
+
+      default:
+        return "unknown";
+    }
+}
+
+void render_manager::add_animation(wf::animation::duration_t *animation,
+    wayfire_view view)
+{
+    pimpl->add_animation(animation, view);
+}
+
+void render_manager::rem_animation(wf::animation::duration_t *animation)
+{
+    pimpl->frame_clock->rem_animation(animation);
+}
+
 void render_manager::add_inhibit(bool add)
 {
     pimpl->add_inhibit(add);
@@ -1483,21 +2418,25 @@ void render_manager::add_inhibit(bool add)
 
 void render_manager::add_effect(effect_hook_t *hook, output_effect_type_t type)
 {
+    hook_profiler::set_owner(hook, __builtin_return_address(0));
     pimpl->effects->add_effect(hook, type);
 }
 
 void render_manager::rem_effect(effect_hook_t *hook)
 {
+    hook_profiler::remove_owner(hook);
     pimpl->effects->rem_effect(hook);
 }
 
 void render_manager::add_post(post_hook_t *hook)
 {
+    hook_profiler::set_owner(hook, __builtin_return_address(0));
     pimpl->postprocessing->add_post(hook);
 }
 
 void render_manager::rem_post(post_hook_t *hook)
 {
+    hook_profiler::remove_owner(hook);
     pimpl->postprocessing->rem_post(hook);
 }
 
@@ -1544,7 +2483,7 @@ void render_manager::workspace_stream_start(workspace_stream_t& stream)
 void render_manager::workspace_stream_update(workspace_stream_t& stream,
     float scale_x, float scale_y)
 {
-    pimpl->workspace_stream_update(stream);
+    pimpl->workspace_stream_update(stream, scale_x, scale_y);
 }
 
 void render_manager::workspace_stream_stop(workspace_stream_t& stream)
@@ -0,0 +1,146 @@
+#include "tile-damage.hpp"
+
+#include <algorithm>
+
+static int div_floor(int a, int b)
+{
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+void wf::tile_damage_t::reset(const wf::geometry_t& bounds)
+{
+    this->bounds  = bounds;
+    columns       = (std::max(bounds.width, 0) + TILE_SIZE - 1) / TILE_SIZE;
+    rows          = (std::max(bounds.height, 0) + TILE_SIZE - 1) / TILE_SIZE;
+    words_per_row = (columns + 63) / 64;
+    bits.assign(words_per_row * rows, 0);
+    has_damage  = false;
+    cache_valid = false;
+}
+
+wf::geometry_t wf::tile_damage_t::get_bounds() const
+{
+    return bounds;
+}
+
+bool wf::tile_damage_t::get_tile_range(const wf::geometry_t& box,
+    int& x1, int& y1, int& x2, int& y2) const
+{
+    if ((box.width <= 0) || (box.height <= 0))
+    {
+        return false;
+    }
+
+    /* Inclusive tile indices, relative to the bounds */
+    x1 = std::max(div_floor(box.x - bounds.x, TILE_SIZE), 0);
+    y1 = std::max(div_floor(box.y - bounds.y, TILE_SIZE), 0);
+    x2 = std::min(div_floor(box.x + box.width - 1 - bounds.x, TILE_SIZE),
+        columns - 1);
+    y2 = std::min(div_floor(box.y + box.height - 1 - bounds.y, TILE_SIZE),
+        rows - 1);
+
+    return (x1 <= x2) && (y1 <= y2);
+}
+
+void wf::tile_damage_t::add(const wf::geometry_t& box)
+{
+    int x1, y1, x2, y2;
+    if (!get_tile_range(box, x1, y1, x2, y2))
+    {
+        return;
+    }
+
+    for (int row = y1; row <= y2; row++)
+    {
+        auto row_bits = &bits[row * words_per_row];
+        for (int word = x1 / 64; word <= x2 / 64; word++)
+        {
+            int first = std::max(x1 - word * 64, 0);
+            int last  = std::min(x2 - word * 64, 63);
+            uint64_t mask = (last == 63 ? ~0ull : ((1ull << (last + 1)) - 1));
+            mask &= ~((1ull << first) - 1);
+            row_bits[word] |= mask;
+        }
+    }
+
+    has_damage  = true;
+    cache_valid = false;
+}
+
+void wf::tile_damage_t::add(const wf::region_t& region)
+{
+    for (const auto& rect : region)
+    {
+        add(wlr_box_from_pixman_box(rect));
+    }
+}
+
+bool wf::tile_damage_t::empty() const
+{
+    return !has_damage;
+}
+
+void wf::tile_damage_t::clear()
+{
+    if (has_damage)
+    {
+        std::fill(bits.begin(), bits.end(), 0);
+        has_damage  = false;
+        cache_valid = false;
+    }
+}
+
+bool wf::tile_damage_t::is_set(int column, int row) const
+{
+    return bits[row * words_per_row + column / 64] & (1ull << (column % 64));
+}
+
+wf::region_t wf::tile_damage_t::to_region(const wf::geometry_t& clip) const
+{
+    wf::region_t result;
+    int x1, y1, x2, y2;
+    if (!has_damage || !get_tile_range(clip, x1, y1, x2, y2))
+    {
+        return result;
+    }
+
+    for (int row = y1; row <= y2; row++)
+    {
+        int column = x1;
+        while (column <= x2)
+        {
+            if (!is_set(column, row))
+            {
+                ++column;
+                continue;
+            }
+
+            int run_start = column;
+            while ((column <= x2) && is_set(column, row))
+            {
+                ++column;
+            }
+
+            /* pixman coalesces equal runs of consecutive rows */
+            result |= wf::geometry_t{
+                bounds.x + run_start * TILE_SIZE,
+                bounds.y + row * TILE_SIZE,
+                (column - run_start) * TILE_SIZE,
+                TILE_SIZE,
+            };
+        }
+    }
+
+    return result & clip;
+}
+
+const wf::region_t& wf::tile_damage_t::to_region() const
+{
+    if (!cache_valid)
+    {
+        cached_region = to_region(bounds);
+        cache_valid   = true;
+    }
+
+    return cached_region;
+}
@@ -0,0 +1,67 @@
+#ifndef WF_TILE_DAMAGE_HPP
+#define WF_TILE_DAMAGE_HPP
+
+#include <vector>
+#include <wayfire/util.hpp>
+
+namespace wf
+{
+/**
+ * Damage tracked as a grid of fixed-size tiles, one bit per tile.
+ *
+ * Adding damage and clipping it is linear in the number of tiles touched,
+ * independent of how fragmented the damage is, and the resulting region never
+ * has more than one rectangle per run of damaged tiles in a row.
+ */
+class tile_damage_t
+{
+  public:
+    static constexpr int TILE_SIZE = 64;
+
+    /**
+     * Clear the damage and cover the given box with tiles. Damage outside of
+     * the bounds is ignored.
+     */
+    void reset(const wf::geometry_t& bounds);
+
+    /** @return The box covered by the tiles. */
+    wf::geometry_t get_bounds() const;
+
+    /** Damage all tiles which intersect the box/region. */
+    void add(const wf::geometry_t& box);
+    void add(const wf::region_t& region);
+
+    bool empty() const;
+    void clear();
+
+    /**
+     * @return The damaged tiles inside the clip box, clipped to it. Only the
+     *   tiles inside the clip box are looked at.
+     */
+    wf::region_t to_region(const wf::geometry_t& clip) const;
+
+    /**
+     * @return All damaged tiles. The region is kept until the damage changes,
+     *   so repeated calls in the same frame are cheap.
+     */
+    const wf::region_t& to_region() const;
+
+  private:
+    wf::geometry_t bounds = {0, 0, 0, 0};
+    int columns = 0;
+    int rows    = 0;
+    size_t words_per_row = 0;
+    std::vector<uint64_t> bits;
+    bool has_damage = false;
+
+    mutable wf::region_t cached_region;
+    mutable bool cache_valid = false;
+
+    /* Range of tiles intersecting the box, false if there are none */
+    bool get_tile_range(const wf::geometry_t& box,
+        int& x1, int& y1, int& x2, int& y2) const;
+    bool is_set(int column, int row) const;
+};
+}
+
+#endif /* end of include guard: WF_TILE_DAMAGE_HPP */
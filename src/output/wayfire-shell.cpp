@@ -9,6 +9,7 @@
 #include "wayfire-shell-unstable-v2-protocol.h"
 #include "wayfire/signal-definitions.hpp"
 #include "../view/view-impl.hpp"
+#include "../core/seat/hotspot-manager.hpp"
 #include <wayfire/util/log.hpp>
 
 /* ----------------------------- wfs_hotspot -------------------------------- */
@@ -21,71 +22,14 @@ static void handle_hotspot_destroy(wl_resource *resource);
 class wfs_hotspot : public noncopyable_t
 {
   private:
-    wf::geometry_t hotspot_geometry;
-
+    wf::output_t *output;
+    wf::hotspot_index_t::hotspot_t hotspot;
     bool hotspot_triggered = false;
-    wf::wl_idle_call idle_check_input;
-    wf::wl_timer timer;
 
-    uint32_t timeout_ms;
     wl_resource *hotspot_resource;
 
-    wf::signal_callback_t on_motion_event = [=] (wf::signal_data_t *data)
-    {
-        idle_check_input.run_once([=] ()
-        {
-            auto gcf = wf::get_core().get_cursor_position();
-            wf::point_t gc{(int)gcf.x, (int)gcf.y};
-            process_input_motion(gc);
-        });
-    };
-
-    wf::signal_callback_t on_touch_motion_event = [=] (wf::signal_data_t *data)
-    {
-        idle_check_input.run_once([=] ()
-        {
-            auto gcf = wf::get_core().get_touch_position(0);
-            wf::point_t gc{(int)gcf.x, (int)gcf.y};
-            process_input_motion(gc);
-        });
-    };
-
     wf::signal_callback_t on_output_removed;
 
-    void process_input_motion(wf::point_t gc)
-    {
-        if (!(hotspot_geometry & gc))
-        {
-            if (hotspot_triggered)
-            {
-                zwf_hotspot_v2_send_leave(hotspot_resource);
-            }
-
-            /* Cursor outside of the hotspot */
-            hotspot_triggered = false;
-            timer.disconnect();
-
-            return;
-        }
-
-        if (hotspot_triggered)
-        {
-            /* Hotspot was already triggered, wait for the next time the cursor
-             * enters the hotspot area to trigger again */
-            return;
-        }
-
-        if (!timer.is_connected())
-        {
-            timer.set_timeout(timeout_ms, [=] ()
-            {
-                hotspot_triggered = true;
-                zwf_hotspot_v2_send_enter(hotspot_resource);
-                return false;
-            });
-        }
-    }
-
     wf::geometry_t calculate_hotspot_geometry(wf::output_t *output,
         uint32_t edge_mask, uint32_t distance) const
     {
@@ -119,9 +63,19 @@ class wfs_hotspot : public noncopyable_t
     wfs_hotspot(wf::output_t *output, uint32_t edge_mask,
         uint32_t distance, uint32_t timeout, wl_client *client, uint32_t id)
     {
-        this->timeout_ms = timeout;
-        this->hotspot_geometry =
-            calculate_hotspot_geometry(output, edge_mask, distance);
+        this->output = output;
+        hotspot.timeout_ms = timeout;
+        hotspot.areas = {calculate_hotspot_geometry(output, edge_mask, distance)};
+        hotspot.on_trigger = [=] ()
+        {
+            hotspot_triggered = true;
+            zwf_hotspot_v2_send_enter(hotspot_resource);
+        };
+        hotspot.on_leave = [=] ()
+        {
+            hotspot_triggered = false;
+            zwf_hotspot_v2_send_leave(hotspot_resource);
+        };
 
         hotspot_resource =
             wl_resource_create(client, &zwf_hotspot_v2_interface, 1, id);
@@ -129,30 +83,32 @@ class wfs_hotspot : public noncopyable_t
             handle_hotspot_destroy);
 
         // setup output destroy listener
-        on_output_removed = [this, output] (wf::signal_data_t *data)
+        on_output_removed = [this] (wf::signal_data_t *data)
         {
             auto ev = static_cast<wf::output_removed_signal*>(data);
-            if (ev->output == output)
+            if (ev->output == this->output)
             {
-                /* Make hotspot inactive by setting the region to empty */
-                hotspot_geometry = {0, 0, 0, 0};
-                process_input_motion({0, 0});
+                /* Make hotspot inactive */
+                wf::hotspot_index_t::get(this->output).rem_hotspot(&hotspot);
+                this->output = nullptr;
+                if (hotspot_triggered)
+                {
+                    hotspot.on_leave();
+                }
             }
         };
 
-        wf::get_core().connect_signal("pointer_motion", &on_motion_event);
-        wf::get_core().connect_signal("tablet_axis", &on_motion_event);
-        wf::get_core().connect_signal("touch_motion", &on_touch_motion_event);
-
+        wf::hotspot_index_t::get(output).add_hotspot(&hotspot);
         wf::get_core().output_layout->connect_signal("output-removed",
             &on_output_removed);
     }
 
     ~wfs_hotspot()
     {
-        wf::get_core().disconnect_signal("pointer_motion", &on_motion_event);
-        wf::get_core().disconnect_signal("tablet_axis", &on_motion_event);
-        wf::get_core().disconnect_signal("touch_motion", &on_touch_motion_event);
+        if (output)
+        {
+            wf::hotspot_index_t::get(output).rem_hotspot(&hotspot);
+        }
 
         wf::get_core().output_layout->disconnect_signal("output-removed",
             &on_output_removed);
@@ -0,0 +1,363 @@
+/**
+ * Implementation of the wayfire-thumbnail-unstable-v1 protocol
+ */
+#include "wayfire/core.hpp"
+#include "wayfire/opengl.hpp"
+#include "wayfire/output.hpp"
+#include "wayfire/util.hpp"
+#include "wayfire-thumbnail.hpp"
+#include "wayfire-thumbnail-unstable-v1-protocol.h"
+#include "../view/view-impl.hpp"
+#include <wayfire/util/log.hpp>
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+/* ------------------------------ wft_thumbnail ------------------------------ */
+static void handle_thumbnail_destroy(wl_resource *resource);
+static void handle_zwf_thumbnail_request_frame(wl_client*, wl_resource *resource);
+static void handle_zwf_thumbnail_destroy(wl_client*, wl_resource *resource)
+{
+    wl_resource_destroy(resource);
+}
+
+static struct zwf_thumbnail_v1_interface zwf_thumbnail_impl = {
+    .request_frame = handle_zwf_thumbnail_request_frame,
+    .destroy = handle_zwf_thumbnail_destroy,
+};
+
+/**
+ * Represents a zwf_thumbnail_v1.
+ * Lifetime is managed by the resource.
+ *
+ * The thumbnail is rendered from the view's snapshot, so only the damaged parts
+ * of the view are re-rendered before a new thumbnail is produced. A new frame
+ * is produced only if the client has requested one, the view has been damaged
+ * since the last frame, and min_interval has passed.
+ */
+class wft_thumbnail : public noncopyable_t
+{
+    wayfire_view view;
+    wl_resource *resource;
+
+    uint32_t max_width, max_height;
+    uint32_t min_interval;
+
+    bool frame_requested = false;
+    bool view_damaged    = true;
+    uint32_t last_frame  = 0;
+
+    wf::wl_timer rate_limit_timer;
+    wf::wl_idle_call idle_render;
+
+    /* The shared memory buffer */
+    int fd = -1;
+    void *data = MAP_FAILED;
+    uint32_t width = 0, height = 0, stride = 0;
+
+    /* The scaled down snapshot, and the pixels read back from it */
+    wf::framebuffer_t fb;
+    std::vector<uint8_t> pixels;
+
+    wf::signal_connection_t on_view_damaged = [=] (wf::signal_data_t*)
+    {
+        view_damaged = true;
+        schedule_frame();
+    };
+
+    wf::signal_connection_t on_view_unmapped = [=] (wf::signal_data_t*)
+    {
+        close();
+    };
+
+    void release_buffer()
+    {
+        if (data != MAP_FAILED)
+        {
+            munmap(data, stride * height);
+            data = MAP_FAILED;
+        }
+
+        if (fd >= 0)
+        {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    /** Make sure the shared buffer has the given size, and announce it */
+    bool ensure_buffer(uint32_t w, uint32_t h)
+    {
+        if ((w == width) && (h == height) && (data != MAP_FAILED))
+        {
+            return true;
+        }
+
+        release_buffer();
+        width  = w;
+        height = h;
+        stride = 4 * w;
+
+        fd = memfd_create("wayfire-thumbnail", MFD_CLOEXEC);
+        if ((fd < 0) || (ftruncate(fd, stride * height) < 0))
+        {
+            LOGE("Failed to allocate thumbnail buffer: ", strerror(errno));
+            release_buffer();
+
+            return false;
+        }
+
+        data = mmap(NULL, stride * height, PROT_READ | PROT_WRITE, MAP_SHARED,
+            fd, 0);
+        if (data == MAP_FAILED)
+        {
+            LOGE("Failed to map thumbnail buffer: ", strerror(errno));
+            release_buffer();
+
+            return false;
+        }
+
+        zwf_thumbnail_v1_send_buffer(resource, fd, WL_SHM_FORMAT_ABGR8888,
+            width, height, stride);
+
+        return true;
+    }
+
+    /** Render the view's snapshot to the shared buffer */
+    bool render_frame()
+    {
+        if (!view->is_mapped() || !view->get_output())
+        {
+            return false;
+        }
+
+        view->take_snapshot();
+        auto& snapshot = view->view_impl->offscreen_buffer;
+        auto geometry  = snapshot.geometry;
+        if (!snapshot.valid() || (geometry.width <= 0) || (geometry.height <= 0))
+        {
+            return false;
+        }
+
+        double scale = std::min({1.0,
+            1.0 * max_width / geometry.width, 1.0 * max_height / geometry.height});
+        uint32_t w = std::max(1, int(geometry.width * scale));
+        uint32_t h = std::max(1, int(geometry.height * scale));
+        if (!ensure_buffer(w, h))
+        {
+            return false;
+        }
+
+        pixels.resize(stride * height);
+        fb.geometry = geometry;
+
+        OpenGL::render_begin();
+        fb.allocate(w, h);
+        fb.bind();
+        OpenGL::clear({0, 0, 0, 0});
+        OpenGL::render_texture(wf::texture_t{snapshot.tex}, fb, geometry);
+        GL_CALL(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+        GL_CALL(glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE,
+            pixels.data()));
+        OpenGL::render_end();
+
+        /* GL rows are stored bottom to top */
+        for (uint32_t row = 0; row < height; row++)
+        {
+            std::memcpy((uint8_t*)data + row * stride,
+                pixels.data() + (height - row - 1) * stride, stride);
+        }
+
+        return true;
+    }
+
+    void send_frame()
+    {
+        if (!frame_requested || !view_damaged || !view)
+        {
+            return;
+        }
+
+        if (render_frame())
+        {
+            frame_requested = false;
+            view_damaged    = false;
+            last_frame = wf::get_current_time();
+            zwf_thumbnail_v1_send_ready(resource);
+        }
+    }
+
+  public:
+    wft_thumbnail(wayfire_view view, wl_client *client, uint32_t version,
+        uint32_t id, uint32_t max_width, uint32_t max_height, uint32_t min_interval)
+    {
+        this->view = view;
+        this->max_width    = std::max(1u, max_width);
+        this->max_height   = std::max(1u, max_height);
+        this->min_interval = min_interval;
+
+        resource = wl_resource_create(client, &zwf_thumbnail_v1_interface,
+            version, id);
+        wl_resource_set_implementation(resource, &zwf_thumbnail_impl, this,
+            handle_thumbnail_destroy);
+
+        if (!view || !view->is_mapped())
+        {
+            close();
+
+            return;
+        }
+
+        view->connect_signal("region-damaged", &on_view_damaged);
+        view->connect_signal("unmapped", &on_view_unmapped);
+    }
+
+    ~wft_thumbnail()
+    {
+        release_buffer();
+        OpenGL::render_begin();
+        fb.release();
+        OpenGL::render_end();
+    }
+
+    /** The view is gone, stop sending frames */
+    void close()
+    {
+        on_view_damaged.disconnect();
+        on_view_unmapped.disconnect();
+        rate_limit_timer.disconnect();
+        idle_render.disconnect();
+        view = nullptr;
+        zwf_thumbnail_v1_send_closed(resource);
+    }
+
+    void request_frame()
+    {
+        frame_requested = true;
+        schedule_frame();
+    }
+
+    /**
+     * Render a new frame at the end of the event loop iteration, so that all
+     * damage in it results in a single frame, and respect the rate limit.
+     */
+    void schedule_frame()
+    {
+        if (!frame_requested || !view_damaged || !view ||
+            rate_limit_timer.is_connected())
+        {
+            return;
+        }
+
+        uint32_t elapsed = wf::get_current_time() - last_frame;
+        if (elapsed < min_interval)
+        {
+            rate_limit_timer.set_timeout(min_interval - elapsed, [=] ()
+            {
+                idle_render.run_once([=] () { send_frame(); });
+                return false;
+            });
+        } else
+        {
+            idle_render.run_once([=] () { send_frame(); });
+        }
+    }
+};
+
+static void handle_zwf_thumbnail_request_frame(wl_client*, wl_resource *resource)
+{
+    auto thumbnail = (wft_thumbnail*)wl_resource_get_user_data(resource);
+    thumbnail->request_frame();
+}
+
+static void handle_thumbnail_destroy(wl_resource *resource)
+{
+    auto thumbnail = (wft_thumbnail*)wl_resource_get_user_data(resource);
+    delete thumbnail;
+    wl_resource_set_user_data(resource, nullptr);
+}
+
+/* -------------------------- wf_thumbnail_manager -------------------------- */
+static wayfire_view view_from_toplevel_resource(wl_resource *toplevel)
+{
+    if (strcmp(wl_resource_get_class(toplevel),
+        "zwlr_foreign_toplevel_handle_v1"))
+    {
+        return nullptr;
+    }
+
+    auto handle =
+        (wlr_foreign_toplevel_handle_v1*)wl_resource_get_user_data(toplevel);
+    if (!handle)
+    {
+        return nullptr;
+    }
+
+    for (auto& view : wf::get_core().get_all_views())
+    {
+        auto wlr_view = dynamic_cast<wf::wlr_view_t*>(view.get());
+        if (wlr_view && (wlr_view->get_toplevel_handle() == handle))
+        {
+            return view;
+        }
+    }
+
+    return nullptr;
+}
+
+static void zwf_thumbnail_manager_capture_toplevel(wl_client *client,
+    wl_resource *resource, uint32_t id, wl_resource *toplevel,
+    uint32_t max_width, uint32_t max_height, uint32_t min_interval)
+{
+    /* Will be freed when the resource is destroyed */
+    new wft_thumbnail(view_from_toplevel_resource(toplevel), client,
+        wl_resource_get_version(resource), id,
+        max_width, max_height, min_interval);
+}
+
+static void zwf_thumbnail_manager_destroy(wl_client*, wl_resource *resource)
+{
+    wl_resource_destroy(resource);
+}
+
+const struct zwf_thumbnail_manager_v1_interface zwf_thumbnail_manager_v1_impl =
+{
+    zwf_thumbnail_manager_capture_toplevel,
+    zwf_thumbnail_manager_destroy,
+};
+
+void bind_zwf_thumbnail_manager(wl_client *client, void *data,
+    uint32_t version, uint32_t id)
+{
+    auto resource =
+        wl_resource_create(client, &zwf_thumbnail_manager_v1_interface,
+            version, id);
+    wl_resource_set_implementation(resource,
+        &zwf_thumbnail_manager_v1_impl, NULL, NULL);
+}
+
+struct wf_thumbnail_manager
+{
+    wl_global *manager;
+};
+
+wf_thumbnail_manager *wf_thumbnail_manager_create(wl_display *display)
+{
+    wf_thumbnail_manager *tm = new wf_thumbnail_manager;
+
+    tm->manager = wl_global_create(display,
+        &zwf_thumbnail_manager_v1_interface, 1, NULL, bind_zwf_thumbnail_manager);
+
+    if (tm->manager == NULL)
+    {
+        LOGE("Failed to create wayfire_thumbnail interface");
+        delete tm;
+
+        return NULL;
+    }
+
+    return tm;
+}
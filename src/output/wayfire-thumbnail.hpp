@@ -0,0 +1,10 @@
+#pragma once
+
+#include <wayland-client.h>
+
+struct wf_thumbnail_manager;
+
+/**
+ * Create the global for the wayfire-thumbnail-unstable-v1 protocol.
+ */
+wf_thumbnail_manager *wf_thumbnail_manager_create(wl_display *display);
@@ -7,6 +7,7 @@
 #include <wayfire/opengl.hpp>
 #include <list>
 #include <algorithm>
+#include <cmath>
 #include <wayfire/nonstd/reverse.hpp>
 #include <wayfire/util/log.hpp>
 
@@ -138,8 +139,9 @@ class output_layer_manager_t
     // A hierarchical representation of the view stack order
     layer_container_t layers[TOTAL_LAYERS];
 
-    // A flat representation of the view stack order
+    // A flat representation of the view stack order, rebuilt on demand
     std::vector<wayfire_view> view_list;
+    bool view_list_dirty = true;
 
   public:
     output_layer_manager_t()
@@ -363,15 +365,26 @@ class output_layer_manager_t
         }
     }
 
+    /**
+     * Invalidate the flat stack order. It is rebuilt the next time it is
+     * needed, so that a burst of changes (for ex. many views mapping at once)
+     * costs a single rebuild.
+     */
     void rebuild_stack_order()
     {
-        this->view_list = _get_views_in_layer(VISIBLE_LAYERS);
+        this->view_list_dirty = true;
     }
 
     std::vector<wayfire_view> get_views_in_layer(uint32_t layers_mask)
     {
         if (layers_mask == VISIBLE_LAYERS)
         {
+            if (view_list_dirty)
+            {
+                this->view_list = _get_views_in_layer(VISIBLE_LAYERS);
+                view_list_dirty = false;
+            }
+
             return view_list;
         } else
         {
@@ -507,9 +520,39 @@ class output_viewport_manager_t
         wf::geometry_t workspace_relative_geometry;
         wlr_box view_bbox = view->get_bounding_box();
 
-        for (int horizontal = 0; horizontal < this->vwidth; horizontal++)
+        /* Only workspaces which the view overlaps can contain it, so instead of
+         * testing every workspace in the grid, test only the range covered by
+         * the bounding box and the wm geometry of the view.
+         *
+         * Sticky views are checked against the current workspace wherever they
+         * are, so with a zero threshold they are on all workspaces. */
+        int x1 = 0, x2 = vwidth - 1;
+        int y1 = 0, y2 = vheight - 1;
+        if (!view->sticky || (threshold > 0))
+        {
+            auto wm  = view->get_wm_geometry();
+            int left = std::min(view_bbox.x, wm.x);
+            int top  = std::min(view_bbox.y, wm.y);
+            int right  = std::max(view_bbox.x + view_bbox.width, wm.x + wm.width);
+            int bottom = std::max(view_bbox.y + view_bbox.height, wm.y + wm.height);
+
+            auto og = output->get_relative_geometry();
+            const auto& ws_index = [] (int coord, int size)
+            {
+                return (int)std::floor(1.0 * coord / size);
+            };
+
+            x1 = std::max(x1, current_vx + ws_index(left, og.width));
+            y1 = std::max(y1, current_vy + ws_index(top, og.height));
+            x2 = std::min(x2,
+                current_vx + ws_index(std::max(right - 1, left), og.width));
+            y2 = std::min(y2,
+                current_vy + ws_index(std::max(bottom - 1, top), og.height));
+        }
+
+        for (int horizontal = x1; horizontal <= x2; horizontal++)
         {
-            for (int vertical = 0; vertical < this->vheight; vertical++)
+            for (int vertical = y1; vertical <= y2; vertical++)
             {
                 wf::point_t ws = {horizontal, vertical};
                 if (output->workspace->view_visible_on(view, ws))
@@ -736,6 +779,9 @@ class output_workarea_manager_t
 
     output_t *output;
 
+    /* Set when a reflow was requested during a map batch */
+    bool reflow_pending = false;
+
   public:
     output_workarea_manager_t(output_t *output)
     {
@@ -791,8 +837,35 @@ class output_workarea_manager_t
         anchors.erase(it, anchors.end());
     }
 
+    /**
+     * Recalculate the workarea. While views are mapped in a batch, the reflow
+     * is postponed until the end of the batch, and get_workarea() keeps
+     * returning the old workarea until then. Listeners of workarea-changed
+     * adjust the views mapped in the batch when the reflow happens.
+     */
     void reflow_reserved_areas()
     {
+        if (wf::get_core().is_map_batch_active())
+        {
+            reflow_pending = true;
+        } else
+        {
+            do_reflow();
+        }
+    }
+
+    void flush_pending_reflow()
+    {
+        if (reflow_pending)
+        {
+            do_reflow();
+        }
+    }
+
+  private:
+    void do_reflow()
+    {
+        reflow_pending = false;
         auto old_workarea = current_workarea;
 
         current_workarea = output->get_relative_geometry();
@@ -887,6 +960,18 @@ class workspace_manager::impl
 
     bool sent_autohide = false;
 
+    /* Set when stack-order-changed was postponed because of a map batch */
+    bool stack_order_changed_pending = false;
+
+    signal_connection_t on_map_batch_done = [=] (signal_data_t*)
+    {
+        workarea_manager.flush_pending_reflow();
+        if (stack_order_changed_pending)
+        {
+            emit_stack_order_changed();
+        }
+    };
+
     std::unique_ptr<workspace_implementation_t> workspace_impl;
 
   public:
@@ -906,6 +991,7 @@ class workspace_manager::impl
         o->connect_signal("output-configuration-changed", &output_geometry_changed);
         o->connect_signal("view-fullscreen", &on_view_state_updated);
         o->connect_signal("view-unmapped", &on_view_state_updated);
+        wf::get_core().connect_signal("map-batch-done", &on_map_batch_done);
     }
 
     workspace_implementation_t *get_implementation()
@@ -973,6 +1059,15 @@ class workspace_manager::impl
 
     void emit_stack_order_changed()
     {
+        /* Listeners (for ex. input focus) only need the final order after all
+         * views in the batch are mapped */
+        if (wf::get_core().is_map_batch_active())
+        {
+            stack_order_changed_pending = true;
+            return;
+        }
+
+        stack_order_changed_pending = false;
         stack_order_changed_signal data;
         data.output = output;
         output->emit_signal("stack-order-changed", &data);
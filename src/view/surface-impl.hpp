@@ -4,6 +4,7 @@
 #include <wayfire/opengl.hpp>
 #include <wayfire/surface.hpp>
 #include <wayfire/util.hpp>
+#include "../core/buffer-latency.hpp"
 
 namespace wf
 {
@@ -51,6 +52,7 @@ class wlr_surface_base_t
   public:
     /* if surface != nullptr, then the surface is mapped */
     wlr_surface *surface = nullptr;
+    wf::buffer_latency::surface_tracker_t latency;
 
     virtual ~wlr_surface_base_t();
 
@@ -266,7 +266,11 @@ wf::wlr_surface_base_t::wlr_surface_base_t(surface_interface_t *self)
     };
 
     on_new_subsurface.set_callback(handle_new_subsurface);
-    on_commit.set_callback([&] (void*) { commit(); });
+    on_commit.set_callback([&] (void*)
+    {
+        latency.committed(surface);
+        commit();
+    });
 }
 
 wf::wlr_surface_base_t::~wlr_surface_base_t()
@@ -419,6 +423,7 @@ void wf::wlr_surface_base_t::_simple_render(const wf::framebuffer_t& fb,
         return;
     }
 
+    latency.sampled(surface);
     auto size = this->_get_size();
     wf::geometry_t geometry = {x, y, size.width, size.height};
     wf::texture_t texture{surface};
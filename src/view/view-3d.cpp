@@ -4,8 +4,10 @@
 #include "wayfire/output.hpp"
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
 
 #define PI 3.14159265359
 
@@ -43,6 +45,24 @@ void wf::view_transformer_t::render_with_damage(wf::texture_t src_tex,
     }
 }
 
+/* FNV-1a over the given floats, continuing from @hash */
+static uint64_t hash_floats(const float *values, size_t count,
+    uint64_t hash = 14695981039346656037ull)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &values[i], sizeof(bits));
+        for (int byte = 0; byte < 4; byte++)
+        {
+            hash ^= (bits >> (byte * 8)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    }
+
+    return hash;
+}
+
 struct transformable_quad
 {
     gl_geometry geometry;
@@ -104,6 +124,13 @@ wf::view_2D::view_2D(wayfire_view view, uint32_t z_order_) : z_order(z_order_)
     this->view = view;
 }
 
+uint64_t wf::view_2D::get_state_hash()
+{
+    const float state[] = {angle, scale_x, scale_y, translation_x,
+        translation_y, alpha};
+    return hash_floats(state, 6) | 1;
+}
+
 static void rotate_xy(float& x, float& y, float angle)
 {
     auto v   = glm::vec4{x, y, 0, 1};
@@ -195,6 +222,16 @@ wf::view_3D::view_3D(wayfire_view view, uint32_t z_order_) : z_order(z_order_)
     view_proj  = default_proj_matrix() * default_view_matrix();
 }
 
+uint64_t wf::view_3D::get_state_hash()
+{
+    uint64_t hash = hash_floats(glm::value_ptr(view_proj), 16);
+    hash = hash_floats(glm::value_ptr(translation), 16, hash);
+    hash = hash_floats(glm::value_ptr(rotation), 16, hash);
+    hash = hash_floats(glm::value_ptr(scaling), 16, hash);
+    hash = hash_floats(glm::value_ptr(color), 4, hash);
+    return hash | 1;
+}
+
 /* TODO: cache total_transform, because it is often unnecessarily recomputed */
 glm::mat4 wf::view_3D::calculate_total_transform()
 {
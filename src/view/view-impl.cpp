@@ -352,6 +352,7 @@ void wf::emit_view_map_signal(wayfire_view view, bool has_position)
     wf::view_mapped_signal data;
     data.view = view;
     data.is_positioned = has_position;
+    wf::get_core_impl().note_view_mapped(view);
     view->get_output()->emit_signal("view-mapped", &data);
     view->emit_signal("mapped", &data);
 }
@@ -1,6 +1,7 @@
 #ifndef VIEW_IMPL_HPP
 #define VIEW_IMPL_HPP
 
+#include <list>
 #include <wayfire/nonstd/safe-list.hpp>
 #include <wayfire/view.hpp>
 #include <wayfire/opengl.hpp>
@@ -22,6 +23,15 @@ struct view_transform_block_t : public noncopyable_t
     std::unique_ptr<wf::view_transformer_t> transform;
     wf::framebuffer_t fb;
 
+    /* The contents of fb are the result of this transform for the given
+     * content version of the view, input box, frame and state of the
+     * transformers up to and including this one, so they can be reused when
+     * the view is rendered again in the same frame. */
+    uint64_t fb_version = 0;
+    uint64_t fb_frame   = 0;
+    uint64_t fb_state   = 0;
+    wf::geometry_t fb_input = {0, 0, 0, 0};
+
     view_transform_block_t();
     ~view_transform_block_t();
 };
@@ -66,6 +76,13 @@ class view_interface_t::view_priv_impl
 
     wf::safe_list_t<std::shared_ptr<view_transform_block_t>> transforms;
 
+    /**
+     * Incremented whenever the contents of the view or its list of transformers
+     * change. Used to tell whether the snapshot and the intermediate results of
+     * the transformers are still up to date.
+     */
+    uint64_t content_version = 1;
+
     struct offscreen_buffer_t : public wf::framebuffer_t
     {
         wf::region_t cached_damage;
@@ -82,6 +99,10 @@ class view_interface_t::view_priv_impl
     /* Promoted to the fullscreen layer? For workspace-manager. */
     bool is_promoted = false;
 
+    /** The focus MRU list which contains the view, see wf::update_focus_mru() */
+    std::list<wayfire_view> *focus_mru = nullptr;
+    std::list<wayfire_view>::iterator focus_mru_position;
+
   private:
     /** Last geometry the view has had in non-tiled and non-fullscreen state.
      * -1 as width/height means that no such geometry has been stored. */
@@ -137,6 +158,12 @@ class wlr_view_t :
     virtual void set_output(wf::output_t*) override;
     bool has_client_decoration = true;
 
+    /** @return The foreign toplevel handle of the view, if it has one. */
+    wlr_foreign_toplevel_handle_v1 *get_toplevel_handle() const
+    {
+        return toplevel_handle;
+    }
+
   protected:
     std::string title, app_id;
     /** Used by view implementations when the app id changes */
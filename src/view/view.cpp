@@ -10,6 +10,7 @@
 #include "wayfire/render-manager.hpp"
 #include "xdg-shell.hpp"
 #include "../output/gtk-shell.hpp"
+#include "../output/output-impl.hpp"
 
 #include <algorithm>
 #include <glm/glm.hpp>
@@ -203,6 +204,11 @@ void wf::view_interface_t::set_output(wf::output_t *new_output)
     data.output = get_output();
 
     surface_interface_t::set_output(new_output);
+    if (new_output != data.output)
+    {
+        wf::update_focus_mru(self());
+    }
+
     if ((new_output != data.output) && new_output)
     {
         view_attached_signal data;
@@ -762,6 +768,7 @@ void wf::view_interface_t::damage()
 {
     auto bbox = get_untransformed_bounding_box();
     view_impl->offscreen_buffer.cached_damage |= bbox;
+    ++view_impl->content_version;
     view_damage_raw(self(), transform_region(bbox));
 }
 
@@ -922,6 +929,7 @@ void wf::view_interface_t::pop_transformer(
     {
         return tr->transform.get() == transformer.get();
     });
+    ++view_impl->content_version;
 
     /* Since we can remove transformers while rendering the output, damaging it
      * won't help at this stage (damage is already calculated).
@@ -1112,7 +1120,18 @@ bool wf::view_interface_t::render_transformed(const wf::framebuffer_t& framebuff
 
     /* Render the view passing its snapshot through the transformers.
      * For each transformer except the last we render on offscreen buffers,
-     * and the last one is rendered to the real fb. */
+     * and the last one is rendered to the real fb.
+     *
+     * A view may be rendered several times in the same frame, for example by
+     * a plugin and by the output. In this case, the offscreen buffers already
+     * contain the right result, unless the view or the parameters of one of
+     * the transformers have changed in the meantime. The frame is identified
+     * by the paint sequence of core, because the view may be painted by an
+     * output other than its own. */
+    uint64_t frame = wf::get_core_impl().paint_sequence;
+    uint64_t version = view_impl->content_version;
+    uint64_t chain_state = 0;
+    bool chain_cacheable = true;
     auto& transforms = view_impl->transforms;
     transforms.for_each([&] (auto& transform) -> void
     {
@@ -1130,18 +1149,37 @@ bool wf::view_interface_t::render_transformed(const wf::framebuffer_t& framebuff
         int scaled_width  = transformed_box.width * texture_scale;
         int scaled_height = transformed_box.height * texture_scale;
 
-        /* Prepare buffer to store result after the transform */
-        OpenGL::render_begin();
-        transform->fb.allocate(scaled_width, scaled_height);
-        transform->fb.scale    = texture_scale;
-        transform->fb.geometry = transformed_box;
-        transform->fb.bind(); // bind buffer to clear it
-        OpenGL::clear({0, 0, 0, 0});
-        OpenGL::render_end();
+        uint64_t state = transform->transform->get_state_hash();
+        chain_cacheable &= (state != 0);
+        chain_state = (chain_state * 1099511628211ull) ^ state;
 
-        /* Actually render the transform to the next framebuffer */
-        transform->transform->render_with_damage(previous_texture, obox,
-            wf::region_t{transformed_box}, transform->fb);
+        bool up_to_date = chain_cacheable && (frame != 0) &&
+            (transform->fb_frame == frame) && (transform->fb_state == chain_state) &&
+            (transform->fb_version == version) && (transform->fb_input == obox) &&
+            (transform->fb.geometry == transformed_box) &&
+            (transform->fb.viewport_width == scaled_width) &&
+            (transform->fb.viewport_height == scaled_height);
+
+        if (!up_to_date)
+        {
+            /* Prepare buffer to store result after the transform */
+            OpenGL::render_begin();
+            transform->fb.allocate(scaled_width, scaled_height);
+            transform->fb.scale    = texture_scale;
+            transform->fb.geometry = transformed_box;
+            transform->fb.bind(); // bind buffer to clear it
+            OpenGL::clear({0, 0, 0, 0});
+            OpenGL::render_end();
+
+            /* Actually render the transform to the next framebuffer */
+            transform->transform->render_with_damage(previous_texture, obox,
+                wf::region_t{transformed_box}, transform->fb);
+
+            transform->fb_frame   = frame;
+            transform->fb_state   = chain_state;
+            transform->fb_version = version;
+            transform->fb_input   = obox;
+        }
 
         previous_transform = transform;
         previous_texture   = previous_transform->fb.tex;
@@ -1253,6 +1291,37 @@ void wf::view_interface_t::take_snapshot()
     offscreen_buffer.cached_damage.clear();
 }
 
+void wf::view_interface_t::downscale_snapshot(float factor)
+{
+    auto& offscreen_buffer = view_impl->offscreen_buffer;
+    if (is_mapped() || !offscreen_buffer.valid() || (factor <= 0) ||
+        (factor >= 1))
+    {
+        return;
+    }
+
+    int scaled_width  = std::max(1, int(offscreen_buffer.viewport_width * factor));
+    int scaled_height =
+        std::max(1, int(offscreen_buffer.viewport_height * factor));
+
+    wf::framebuffer_t downscaled;
+    downscaled.geometry = offscreen_buffer.geometry;
+    downscaled.scale    = offscreen_buffer.scale * factor;
+
+    OpenGL::render_begin();
+    downscaled.allocate(scaled_width, scaled_height);
+    downscaled.bind();
+    OpenGL::clear({0, 0, 0, 0});
+    OpenGL::render_texture(wf::texture_t{offscreen_buffer.tex}, downscaled,
+        downscaled.geometry);
+
+    /* Releases the old snapshot */
+    offscreen_buffer.scale = downscaled.scale;
+    ++view_impl->content_version;
+    static_cast<wf::framebuffer_base_t&>(offscreen_buffer) = std::move(downscaled);
+    OpenGL::render_end();
+}
+
 wf::view_interface_t::view_interface_t()
 {
     this->view_impl = std::make_unique<wf::view_interface_t::view_priv_impl>();
@@ -1309,6 +1378,7 @@ void wf::view_interface_t::damage_surface_box(const wlr_box& box)
     damaged.x += obox.x;
     damaged.y += obox.y;
     view_impl->offscreen_buffer.cached_damage |= damaged;
+    ++view_impl->content_version;
     view_damage_raw(self(), transform_region(damaged));
 }
 